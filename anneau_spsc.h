@@ -0,0 +1,167 @@
+#ifndef ANNEAU_SPSC_H
+#define ANNEAU_SPSC_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace teleporteur {
+
+// **Anneau à un producteur et un consommateur**
+// Sans verrou : chacun n'écrit que son propre indice, l'autre le lit. Chaque côté
+// garde une copie de l'indice de l'autre et ne relit l'original (ligne de cache
+// partagée) que quand l'anneau lui semble plein ou vide. Celui qui doit attendre
+// tourne un peu, cède son cœur quelques fois, puis dort sur une variable de
+// condition : un flux lent en entrée n'occupe pas deux cœurs à ne rien faire.
+// L'autre côté ne prend le verrou que s'il le voit endormi. Il regarde sans
+// barrière, pour ne rien coûter à chaque élément : un réveil peut alors se perdre,
+// et le dormeur se réveille aussi de lui-même toutes les millisecondes.
+// fermer() (producteur) annonce la fin des éléments, arreter() (consommateur)
+// débloque un producteur qui attendrait de la place pour rien.
+template <class T>
+class AnneauSpsc
+{
+public:
+    explicit AnneauSpsc(std::size_t capacite) // Arrondie à une puissance de 2
+    {
+        std::size_t taille = 2;
+        while (taille < capacite)
+        {
+            taille *= 2;
+        }
+        cases.resize(taille);
+        masque = taille - 1;
+    }
+
+    // Producteur : faux seulement si le consommateur s'est arrêté
+    bool pousser(const T& element)
+    {
+        std::size_t position = queue.load(std::memory_order_relaxed);
+        for (int essais = 0; position - tete_vue > masque;)
+        {
+            tete_vue = tete.load(std::memory_order_acquire);
+            if (position - tete_vue > masque)
+            {
+                if (arret.load(std::memory_order_relaxed))
+                {
+                    return false;
+                }
+                if (!patienter(essais))
+                {
+                    dormir(producteur_endormi, [&] {
+                        return position - tete.load(std::memory_order_acquire) <= masque ||
+                               arret.load(std::memory_order_relaxed);
+                    });
+                }
+            }
+        }
+        cases[position & masque] = element;
+        queue.store(position + 1, std::memory_order_release);
+        reveiller(consommateur_endormi);
+        return true;
+    }
+    void fermer()
+    {
+        ferme.store(true, std::memory_order_release);
+        reveiller(consommateur_endormi, true);
+    }
+
+    // Consommateur : jusqu'à nb éléments ; attend s'il n'y en a aucun, 0 à la fin
+    std::size_t retirer(T* elements, std::size_t nb)
+    {
+        std::size_t position = tete.load(std::memory_order_relaxed);
+        for (int essais = 0; queue_vue == position;)
+        {
+            bool fini = ferme.load(std::memory_order_acquire); // Avant queue : rien de poussé n'est perdu
+            queue_vue = queue.load(std::memory_order_acquire);
+            if (queue_vue == position)
+            {
+                if (fini)
+                {
+                    return 0;
+                }
+                if (!patienter(essais))
+                {
+                    dormir(consommateur_endormi, [&] {
+                        return queue.load(std::memory_order_acquire) != position ||
+                               ferme.load(std::memory_order_acquire);
+                    });
+                }
+            }
+        }
+        std::size_t n = 0;
+        for (; n < nb && position + n != queue_vue; ++n)
+        {
+            elements[n] = cases[(position + n) & masque];
+        }
+        tete.store(position + n, std::memory_order_release);
+        reveiller(producteur_endormi);
+        return n;
+    }
+    // Consommateur : vrai si retirer() rendrait quelque chose sans attendre
+    bool pret()
+    {
+        if (queue_vue == tete.load(std::memory_order_relaxed))
+        {
+            queue_vue = queue.load(std::memory_order_acquire);
+        }
+        return queue_vue != tete.load(std::memory_order_relaxed) || ferme.load(std::memory_order_acquire);
+    }
+    void arreter()
+    {
+        arret.store(true, std::memory_order_relaxed);
+        reveiller(producteur_endormi, true);
+    }
+
+private:
+    // Faux quand il est temps de dormir
+    static bool patienter(int& essais)
+    {
+        if (essais >= 128)
+        {
+            return false;
+        }
+        if (++essais > 64)
+        {
+            std::this_thread::yield();
+        }
+        return true;
+    }
+    template <class Condition>
+    void dormir(std::atomic<bool>& endormi, Condition condition)
+    {
+        std::unique_lock<std::mutex> garde(verrou);
+        endormi.store(true, std::memory_order_seq_cst);
+        reveil.wait_for(garde, std::chrono::milliseconds(1), condition);
+        endormi.store(false, std::memory_order_relaxed);
+    }
+    void reveiller(std::atomic<bool>& endormi, bool toujours = false)
+    {
+        if (toujours || endormi.load(std::memory_order_relaxed))
+        {
+            std::lock_guard<std::mutex> garde(verrou);
+            reveil.notify_all();
+        }
+    }
+
+    std::vector<T> cases;
+    std::size_t masque;
+    alignas(64) std::atomic<std::size_t> tete{0};   // Prochaine case à lire
+    std::size_t queue_vue = 0;                      // Copie du consommateur
+    alignas(64) std::atomic<std::size_t> queue{0};  // Prochaine case à écrire
+    std::size_t tete_vue = 0;                       // Copie du producteur
+    alignas(64) std::atomic<bool> ferme{false};
+    std::atomic<bool> arret{false};
+    std::atomic<bool> producteur_endormi{false};    // Écrits seulement pour dormir :
+    std::atomic<bool> consommateur_endormi{false};  // la ligne reste partagée
+    std::mutex verrou;
+    std::condition_variable reveil;
+};
+
+} // teleporteur
+
+#endif
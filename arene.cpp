@@ -0,0 +1,44 @@
+#include "arene.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace teleporteur
+{
+
+    Arene::Arene(size_t taille_bloc) : taille_bloc(max<size_t>(taille_bloc, 4096)) {}
+
+    // Plusieurs blocs : l'arène a grandi pendant ce scénario, un seul bloc de la
+    // taille totale suffira aux suivants. Sinon rien n'est rendu ni alloué.
+    void Arene::vider()
+    {
+        if (blocs.size() > 1)
+        {
+            size_t total = octets_reserves();
+            blocs.clear();
+            ajouter_bloc(total);
+        }
+        position = 0;
+        utilises = 0;
+    }
+
+    size_t Arene::octets_reserves() const
+    {
+        size_t total = 0;
+        for (const Bloc &bloc : blocs)
+        {
+            total += bloc.taille;
+        }
+        return total;
+    }
+
+    // Au moins le double du dernier bloc, pour qu'une arène qui grandit alloue peu de fois
+    void Arene::ajouter_bloc(size_t octets_minimum)
+    {
+        size_t taille = max(octets_minimum, blocs.empty() ? taille_bloc : blocs.back().taille * 2);
+        blocs.push_back(Bloc{unique_ptr<char[]>(new char[taille]), taille});
+        position = 0;
+    }
+
+} // teleporteur
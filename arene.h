@@ -0,0 +1,62 @@
+#ifndef ARENE_H
+#define ARENE_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace teleporteur {
+
+// **Arène d'allocation**
+// Mémoire distribuée en avançant un pointeur dans un bloc, rendue d'un coup par
+// vider() en O(1). Quand le bloc est plein, un bloc plus grand s'ajoute ; au
+// vider() suivant, les blocs sont remplacés par un seul de leur taille totale.
+// Une suite de scénarios de tailles voisines n'alloue donc plus rien après les
+// premiers et retrouve ses pages déjà en mémoire. Rien n'est construit ni
+// détruit : seulement pour des types triviaux (int, long long...). Un pointeur
+// rendu par allouer() ne sert plus après vider().
+class Arene
+{
+public:
+    explicit Arene(std::size_t taille_bloc = 1 << 20);
+    Arene(const Arene&) = delete;
+    Arene& operator=(const Arene&) = delete;
+
+    template <class T>
+    T* allouer(std::size_t nb)
+    {
+        std::size_t octets = nb * sizeof(T);
+        std::size_t debut = (position + alignof(T) - 1) & ~(alignof(T) - 1);
+        if (blocs.empty() || debut + octets > blocs.back().taille)
+        {
+            ajouter_bloc(octets);
+            debut = 0; // new char[] est aligné pour tout type de base
+        }
+        position = debut + octets;
+        utilises += octets;
+        return reinterpret_cast<T*>(blocs.back().memoire.get() + debut);
+    }
+    void vider();
+
+    std::size_t octets_utilises() const { return utilises; }  // Depuis le dernier vider()
+    std::size_t octets_reserves() const;                       // Somme des blocs gardés
+    std::size_t nb_blocs() const { return blocs.size(); }
+
+private:
+    struct Bloc
+    {
+        std::unique_ptr<char[]> memoire;
+        std::size_t taille;
+    };
+
+    void ajouter_bloc(std::size_t octets_minimum);
+
+    std::vector<Bloc> blocs;                       // On alloue dans le dernier
+    std::size_t taille_bloc;
+    std::size_t position = 0;                      // Premier octet libre du dernier bloc
+    std::size_t utilises = 0;
+};
+
+} // teleporteur
+
+#endif
@@ -0,0 +1,430 @@
+#include "teleporteur.h"
+#include "tampon_sortie.h"
+#include "generateur.h"
+#include "arene.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+using namespace teleporteur;
+
+// **Banc d'essai des moteurs**
+// Génère les charges en mémoire et mesure séparément la lecture du texte, la
+// simulation sans trace et la simulation avec trace SHOW_CYCLES (écrite dans
+// /dev/null). Sans trace, NEQLI passe par son moteur rapide : pour isoler la
+// sortie, le moteur de la trace tourne aussi seul (+cycles, cycles détournés vers
+// un rappel vide) et +sortie est l'écart entre +trace et +cycles, c'est-à-dire le
+// formatage et l'écriture. Chaque mesure est une ligne JSON, comparable à un
+// passage précédent.
+
+struct Mesure {
+	std::string charge;
+	int nb_files;
+	long long nb_robots;
+	std::string phase;
+	double secondes;
+	long long cycles;          // 0 pour la lecture
+	long rss_max_ko;
+};
+
+// Reçoit les cycles de +cycles sans rien en faire
+static void ignorer_cycle(void*, long long, long long, long long, bool, bool) {}
+
+// **Comptage des allocations**
+// Toutes les allocations du programme passent par ici ; l'endurance en donne le
+// nombre par itération. Hors ligne : sinon GCC voit free() appliqué au résultat
+// de new et avertit à tort.
+static std::atomic<long long> nb_allocations(0);
+static std::atomic<long long> octets_alloues(0);
+
+__attribute__((noinline)) void* operator new(std::size_t taille) {
+	nb_allocations.fetch_add(1, std::memory_order_relaxed);
+	octets_alloues.fetch_add(static_cast<long long>(taille), std::memory_order_relaxed);
+	if (void* p = std::malloc(taille == 0 ? 1 : taille)) {
+		return p;
+	}
+	throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept {
+	std::free(p);
+}
+
+__attribute__((noinline)) void operator delete(void* p, std::size_t) noexcept {
+	std::free(p);
+}
+
+static double maintenant() {
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static long rss_max_ko() {
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss; // Pic du processus depuis son début (Ko sous Linux)
+}
+
+static long rss_courant_ko() {
+	long pages_totales = 0, pages_resident = 0;
+	std::FILE* statm = std::fopen("/proc/self/statm", "r");
+	if (statm != nullptr) {
+		if (std::fscanf(statm, "%ld %ld", &pages_totales, &pages_resident) != 2) {
+			pages_resident = 0;
+		}
+		std::fclose(statm);
+	}
+	return pages_resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+// Meilleur temps sur plusieurs répétitions
+template <class Fonction>
+static double chronometrer(int repetitions, Fonction fonction) {
+	double meilleur = 1e300;
+	for (int r = 0; r < repetitions; ++r) {
+		double debut = maintenant();
+		fonction();
+		meilleur = std::min(meilleur, maintenant() - debut);
+	}
+	return meilleur;
+}
+
+static std::vector<std::string> decouper(const std::string& liste) {
+	std::vector<std::string> morceaux;
+	size_t debut = 0;
+	while (debut <= liste.size()) {
+		size_t fin = std::min(liste.find(',', debut), liste.size());
+		morceaux.push_back(liste.substr(debut, fin - debut));
+		debut = fin + 1;
+	}
+	return morceaux;
+}
+
+static void ecrire_json(const Mesure& m, std::FILE* flux) {
+	double ns_par_robot = m.nb_robots > 0 ? m.secondes * 1e9 / m.nb_robots : 0;
+	double cycles_par_seconde = m.secondes > 0 ? m.cycles / m.secondes : 0;
+	std::fprintf(flux, "{\"charge\":\"%s\",\"nb_files\":%d,\"nb_robots\":%lld,\"phase\":\"%s\","
+	                   "\"secondes\":%.6f,\"cycles\":%lld,\"cycles_par_seconde\":%.0f,"
+	                   "\"ns_par_robot\":%.2f,\"rss_max_ko\":%ld}\n",
+	             m.charge.c_str(), m.nb_files, m.nb_robots, m.phase.c_str(), m.secondes, m.cycles,
+	             cycles_par_seconde, ns_par_robot, m.rss_max_ko);
+}
+
+static std::string cle(const std::string& charge, int nb_files, long long nb_robots, const std::string& phase) {
+	return charge + "/" + std::to_string(nb_files) + "/" + std::to_string(nb_robots) + "/" + phase;
+}
+
+// Extraction des champs d'une ligne écrite par ecrire_json()
+static std::string champ(const std::string& ligne, const std::string& nom) {
+	size_t position = ligne.find("\"" + nom + "\":");
+	if (position == std::string::npos) {
+		return "";
+	}
+	position += nom.size() + 3;
+	if (ligne[position] == '"') {
+		return ligne.substr(position + 1, ligne.find('"', position + 1) - position - 1);
+	}
+	return ligne.substr(position, ligne.find_first_of(",}", position) - position);
+}
+
+static bool lire_reference(const std::string& chemin, std::map<std::string, double>& reference) {
+	std::ifstream fichier(chemin);
+	if (!fichier) {
+		return false;
+	}
+	std::string ligne;
+	while (std::getline(fichier, ligne)) {
+		if (ligne.empty()) {
+			continue;
+		}
+		reference[cle(champ(ligne, "charge"), std::atoi(champ(ligne, "nb_files").c_str()),
+		              std::atoll(champ(ligne, "nb_robots").c_str()), champ(ligne, "phase"))] =
+			std::atof(champ(ligne, "secondes").c_str());
+	}
+	return true;
+}
+
+// **Endurance**
+// Tire à chaque itération une charge, un nombre de files et de robots dans les
+// listes données et une graine, range le scénario dans l'arène, le simule avec
+// chaque politique puis vide l'arène. Une ligne par seconde ; avec --json, une
+// ligne par itération (graine comprise, pour la rejouer). Une fois l'arène à la
+// taille des plus gros scénarios, les allocations qui restent sont celles des
+// moteurs, et le RSS ne doit plus monter.
+struct Endurance {
+	double secondes;
+	long long iterations;          // 0 : jusqu'à la fin du temps
+	std::vector<TypeCharge> charges;
+	std::vector<int> liste_files;
+	std::vector<long long> liste_robots;
+	std::vector<TypePolitique> politiques;
+	std::uint64_t graine;
+};
+
+static int endurance(const Endurance& e, std::FILE* json) {
+	std::mt19937_64 aleatoire(e.graine);
+	auto choisir = [&](size_t n) { return static_cast<size_t>(aleatoire() % n); };
+	Arene arene;
+	Parametres param;
+	long rss_depart = rss_courant_ko();
+	double debut = maintenant(), prochain_affichage = debut + 1;
+	long long iteration = 0, robots = 0, cycles = 0, allocations = 0, allocations_max = 0;
+	std::printf("%10s %12s %14s %14s %12s %10s %10s\n", "iteration", "secondes", "robots/s", "allocations/it",
+	            "arene(Mo)", "rss(Mo)", "rss max");
+	while (maintenant() - debut < e.secondes && (e.iterations == 0 || iteration < e.iterations)) {
+		DescriptionCharge charge;
+		charge.type = e.charges[choisir(e.charges.size())];
+		charge.nb_files = e.liste_files[choisir(e.liste_files.size())];
+		charge.nb_robots = e.liste_robots[choisir(e.liste_robots.size())];
+		charge.graine = aleatoire();
+
+		long long allocations_avant = nb_allocations.load(std::memory_order_relaxed);
+		long long octets_avant = octets_alloues.load(std::memory_order_relaxed);
+		double debut_iteration = maintenant();
+		arene.vider();
+		generer_parametres(charge, param, arene);
+		double generation = maintenant() - debut_iteration;
+		long long cycles_iteration = 0;
+		for (TypePolitique politique : e.politiques) {
+			cycles_iteration += simuler_politique(politique, param, nullptr).cycles;
+		}
+		double duree = maintenant() - debut_iteration;
+		long long allocations_iteration = nb_allocations.load(std::memory_order_relaxed) - allocations_avant;
+		long long octets_iteration = octets_alloues.load(std::memory_order_relaxed) - octets_avant;
+
+		++iteration;
+		robots += charge.nb_robots;
+		cycles += cycles_iteration;
+		allocations += allocations_iteration;
+		allocations_max = std::max(allocations_max, allocations_iteration);
+		if (json != nullptr) {
+			std::fprintf(json, "{\"iteration\":%lld,\"charge\":\"%s\",\"nb_files\":%d,\"nb_robots\":%lld,"
+			                   "\"graine\":%llu,\"generation\":%.6f,\"secondes\":%.6f,\"cycles\":%lld,"
+			                   "\"allocations\":%lld,\"octets_alloues\":%lld,\"arene_ko\":%zu,"
+			                   "\"rss_ko\":%ld,\"rss_max_ko\":%ld}\n",
+			             iteration, nom_charge(charge.type), charge.nb_files, charge.nb_robots,
+			             static_cast<unsigned long long>(charge.graine), generation, duree, cycles_iteration,
+			             allocations_iteration, octets_iteration, arene.octets_reserves() / 1024, rss_courant_ko(),
+			             rss_max_ko());
+		}
+		double ecoulees = maintenant();
+		if (ecoulees >= prochain_affichage) {
+			prochain_affichage = ecoulees + 1;
+			std::printf("%10lld %12.1f %14.0f %14.1f %12.1f %10.1f %10.1f\n", iteration, ecoulees - debut,
+			            robots / (ecoulees - debut), static_cast<double>(allocations) / iteration,
+			            arene.octets_reserves() / 1048576.0, rss_courant_ko() / 1024.0, rss_max_ko() / 1024.0);
+			std::fflush(stdout);
+		}
+	}
+	double total = maintenant() - debut;
+	std::printf("%lld itérations en %.1f s : %lld robots, %lld cycles, %.1f allocations par itération (max %lld), "
+	            "RSS %.1f -> %.1f Mo\n", iteration, total, robots, cycles,
+	            iteration > 0 ? static_cast<double>(allocations) / iteration : 0.0, allocations_max,
+	            rss_depart / 1024.0, rss_courant_ko() / 1024.0);
+	return 0;
+}
+
+static int usage(const char* programme) {
+	std::fprintf(stderr,
+	             "Usage : %s [--charges uniforme,zipf,auto,zero,ping_pong] [--files 10,1000,...]\n"
+	             "          [--robots 1000000,...] [--politiques neqli,faneqli] [--graine N]\n"
+	             "          [--repetitions R] [--json FICHIER] [--comparer FICHIER]\n"
+	             "          [--sans-lecture] [--sans-trace]\n"
+	             "       %s --endurance SECONDES [--iterations N] [--charges ...] [--files ...]\n"
+	             "          [--robots ...] [--politiques ...] [--graine N] [--json FICHIER]\n", programme, programme);
+	return 1;
+}
+
+int main(int argc, char* argv[]) {
+	std::vector<std::string> charges = {"uniforme", "zipf", "auto", "zero", "ping_pong"};
+	std::vector<std::string> liste_files = {"10", "1000", "100000"};
+	std::vector<std::string> liste_robots = {"1000000"};
+	std::vector<std::string> liste_politiques = {"neqli", "faneqli"};
+	std::uint64_t graine = 1;
+	int repetitions = 3;
+	std::string chemin_json, chemin_reference;
+	bool avec_lecture = true, avec_trace = true;
+	double secondes_endurance = 0;
+	long long iterations = 0;
+
+	for (int i = 1; i < argc; ++i) {
+		bool suivant = i + 1 < argc;
+		if (std::strcmp(argv[i], "--charges") == 0 && suivant) {
+			charges = decouper(argv[++i]);
+		} else if (std::strcmp(argv[i], "--files") == 0 && suivant) {
+			liste_files = decouper(argv[++i]);
+		} else if (std::strcmp(argv[i], "--robots") == 0 && suivant) {
+			liste_robots = decouper(argv[++i]);
+		} else if (std::strcmp(argv[i], "--politiques") == 0 && suivant) {
+			liste_politiques = decouper(argv[++i]);
+		} else if (std::strcmp(argv[i], "--graine") == 0 && suivant) {
+			graine = std::strtoull(argv[++i], nullptr, 10);
+		} else if (std::strcmp(argv[i], "--repetitions") == 0 && suivant) {
+			repetitions = std::max(1, std::atoi(argv[++i]));
+		} else if (std::strcmp(argv[i], "--json") == 0 && suivant) {
+			chemin_json = argv[++i];
+		} else if (std::strcmp(argv[i], "--comparer") == 0 && suivant) {
+			chemin_reference = argv[++i];
+		} else if (std::strcmp(argv[i], "--endurance") == 0 && suivant) {
+			secondes_endurance = std::atof(argv[++i]);
+			if (secondes_endurance <= 0) {
+				return usage(argv[0]);
+			}
+		} else if (std::strcmp(argv[i], "--iterations") == 0 && suivant) {
+			iterations = std::max(0LL, std::atoll(argv[++i]));
+		} else if (std::strcmp(argv[i], "--sans-lecture") == 0) {
+			avec_lecture = false;
+		} else if (std::strcmp(argv[i], "--sans-trace") == 0) {
+			avec_trace = false;
+		} else {
+			return usage(argv[0]);
+		}
+	}
+
+	std::vector<TypePolitique> politiques;
+	for (const std::string& nom : liste_politiques) {
+		TypePolitique politique;
+		if (!lire_politique(nom, politique)) {
+			return usage(argv[0]);
+		}
+		politiques.push_back(politique);
+	}
+	std::map<std::string, double> reference;
+	if (!chemin_reference.empty() && !lire_reference(chemin_reference, reference)) {
+		std::fprintf(stderr, "Impossible de lire %s\n", chemin_reference.c_str());
+		return 1;
+	}
+	std::FILE* json = nullptr;
+	if (!chemin_json.empty() && (json = std::fopen(chemin_json.c_str(), "w")) == nullptr) {
+		std::fprintf(stderr, "Impossible d'écrire %s\n", chemin_json.c_str());
+		return 1;
+	}
+	if (secondes_endurance > 0) {
+		Endurance e{secondes_endurance, iterations, {}, {}, {}, politiques, graine};
+		for (const std::string& nom : charges) {
+			TypeCharge type;
+			if (!lire_charge(nom, type)) {
+				return usage(argv[0]);
+			}
+			e.charges.push_back(type);
+		}
+		for (const std::string& texte : liste_files) {
+			e.liste_files.push_back(std::atoi(texte.c_str()));
+			if (e.liste_files.back() <= 0) {
+				return usage(argv[0]);
+			}
+		}
+		for (const std::string& texte : liste_robots) {
+			e.liste_robots.push_back(std::atoll(texte.c_str()));
+			if (e.liste_robots.back() < 0) {
+				return usage(argv[0]);
+			}
+		}
+		int code = endurance(e, json);
+		if (json != nullptr) {
+			std::fclose(json);
+		}
+		return code;
+	}
+	std::FILE* poubelle = std::fopen("/dev/null", "w");
+
+	std::printf("%-10s %10s %11s %-16s %10s %14s %10s %10s%s\n", "charge", "files", "robots", "phase",
+	            "secondes", "cycles/s", "ns/robot", "rss(Mo)", reference.empty() ? "" : "   vs ref");
+	int nb_regressions = 0;
+	for (const std::string& nom : charges) {
+		for (const std::string& texte_files : liste_files) {
+			for (const std::string& texte_robots : liste_robots) {
+				DescriptionCharge charge;
+				if (!lire_charge(nom, charge.type)) {
+					return usage(argv[0]);
+				}
+				charge.nb_files = std::atoi(texte_files.c_str());
+				charge.nb_robots = std::atoll(texte_robots.c_str());
+				charge.graine = graine;
+				if (charge.nb_files <= 0 || charge.nb_robots < 0) {
+					return usage(argv[0]);
+				}
+
+				std::vector<Mesure> mesures;
+				Parametres param;
+				if (avec_lecture) {
+					std::string texte = generer_texte(charge, "SHOW_NO_CYCLE");
+					double secondes = chronometrer(repetitions, [&] {
+						bool error_trouve = false;
+						param = Parametres();
+						analyser_parametres(texte.data(), texte.data() + texte.size(), param, error_trouve);
+					});
+					mesures.push_back({nom, charge.nb_files, charge.nb_robots, "lecture", secondes, 0, rss_max_ko()});
+				} else {
+					generer_parametres(charge, param);
+				}
+
+				for (TypePolitique politique : politiques) {
+					std::string phase = nom_politique(politique);
+					std::transform(phase.begin(), phase.end(), phase.begin(), ::tolower);
+					Resultats resultats;
+					double secondes = chronometrer(repetitions, [&] {
+						resultats = simuler_politique(politique, param, nullptr);
+					});
+					mesures.push_back({nom, charge.nb_files, charge.nb_robots, phase, secondes,
+					                   resultats.cycles, rss_max_ko()});
+					if (avec_trace) {
+						double secondes_cycles = chronometrer(repetitions, [&] {
+							TamponSortie trace(poubelle, 1 << 20);
+							trace.detourner_cycles(ignorer_cycle, nullptr);
+							resultats = simuler_politique(politique, param, &trace);
+						});
+						mesures.push_back({nom, charge.nb_files, charge.nb_robots, phase + "+cycles",
+						                   secondes_cycles, resultats.cycles, rss_max_ko()});
+						secondes = chronometrer(repetitions, [&] {
+							TamponSortie trace(poubelle, 1 << 20);
+							resultats = simuler_politique(politique, param, &trace);
+						});
+						mesures.push_back({nom, charge.nb_files, charge.nb_robots, phase + "+trace", secondes,
+						                   resultats.cycles, rss_max_ko()});
+						mesures.push_back({nom, charge.nb_files, charge.nb_robots, phase + "+sortie",
+						                   std::max(0.0, secondes - secondes_cycles), resultats.cycles,
+						                   rss_max_ko()});
+					}
+				}
+
+				for (const Mesure& m : mesures) {
+					std::printf("%-10s %10d %11lld %-16s %10.4f %14.0f %10.2f %10.1f", m.charge.c_str(),
+					            m.nb_files, m.nb_robots, m.phase.c_str(), m.secondes,
+					            m.secondes > 0 ? m.cycles / m.secondes : 0,
+					            m.nb_robots > 0 ? m.secondes * 1e9 / m.nb_robots : 0, m.rss_max_ko / 1024.0);
+					auto ancienne = reference.find(cle(m.charge, m.nb_files, m.nb_robots, m.phase));
+					if (ancienne != reference.end() && ancienne->second > 0) {
+						double rapport = m.secondes / ancienne->second;
+						bool regression = rapport > 1.10;
+						nb_regressions += regression;
+						std::printf("   x%.2f%s", rapport, regression ? " (plus lent)" : "");
+					}
+					std::printf("\n");
+					if (json != nullptr) {
+						ecrire_json(m, json);
+					}
+				}
+				std::fflush(stdout);
+			}
+		}
+	}
+
+	if (json != nullptr) {
+		std::fclose(json);
+	}
+	std::fclose(poubelle);
+	return nb_regressions == 0 ? 0 : 3;
+}
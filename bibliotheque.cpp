@@ -0,0 +1,133 @@
+#include "bibliotheque.h"
+#include "teleporteur_c.h"
+
+#include <new>
+
+using namespace std;
+
+namespace teleporteur
+{
+
+    string emprunter_files(int nb_files, const int *debuts, const int *destinations, Parametres &param)
+    {
+        param.affichage_type = "SHOW_NO_CYCLE";
+        param.nb_files = nb_files;
+        param.numeros.clear();
+        param.debuts.clear();
+        param.destinations.clear();
+        bool error_trouve = false;
+        if (nb_files > 0)
+        {
+            // Mêmes garanties que la lecture du texte : les moteurs ne vérifient plus rien
+            error_trouve = debuts == nullptr || debuts[0] != 0;
+            for (int i = 0; !error_trouve && i < nb_files; ++i)
+            {
+                error_trouve = debuts[i + 1] < debuts[i];
+            }
+            int nb_robots = error_trouve ? 0 : debuts[nb_files];
+            error_trouve = error_trouve || (nb_robots > 0 && destinations == nullptr);
+            for (int r = 0; !error_trouve && r < nb_robots; ++r)
+            {
+                error_trouve = destinations[r] < 0 || destinations[r] >= nb_files;
+            }
+            if (!error_trouve)
+            {
+                param.debuts.emprunter(debuts, static_cast<size_t>(nb_files) + 1);
+                param.destinations.emprunter(destinations, nb_robots);
+            }
+        }
+        return verifier_parametres(param, error_trouve);
+    }
+
+    Resultats simuler_avec_rappel(TypePolitique politique, const Parametres &param, RappelCycle rappel,
+                                  void *contexte, Quantiles quantiles)
+    {
+        if (rappel == nullptr)
+        {
+            return simuler_politique(politique, param, nullptr, nullptr, quantiles);
+        }
+        TamponSortie trace(nullptr, 64); // Ne reçoit aucun texte : tout passe par le rappel
+        trace.detourner_cycles(rappel, contexte);
+        return simuler_politique(politique, param, &trace, nullptr, quantiles);
+    }
+
+} // teleporteur
+
+// **Interface C**
+// Aucune exception ne traverse l'interface : un manque de mémoire devient un code.
+
+using namespace teleporteur;
+
+namespace
+{
+    struct RappelC
+    {
+        teleporteur_rappel_cycle rappel;
+        void *contexte;
+    };
+
+    void transmettre_cycle(void *contexte, long long cycle, long long depart, long long arrivee, bool sortie,
+                           bool entree)
+    {
+        const RappelC &rappel = *static_cast<const RappelC *>(contexte);
+        rappel.rappel(rappel.contexte, cycle, depart, arrivee, sortie ? 1 : 0, entree ? 1 : 0);
+    }
+}
+
+extern "C" int teleporteur_simuler(int politique, int nb_files, const int *debuts, const int *destinations,
+                                   teleporteur_rappel_cycle rappel, void *contexte, teleporteur_resultats *resultats)
+{
+    if (politique < TELEPORTEUR_NEQLI || politique > TELEPORTEUR_SCAN)
+    {
+        return TELEPORTEUR_ERREUR_POLITIQUE;
+    }
+    try
+    {
+        Parametres param;
+        if (!emprunter_files(nb_files, debuts, destinations, param).empty())
+        {
+            return nb_files <= 0 ? TELEPORTEUR_ERREUR_NB_FILES : TELEPORTEUR_ERREUR_FILES;
+        }
+        RappelC rappel_c = {rappel, contexte};
+        Resultats resultats_cpp = simuler_avec_rappel(static_cast<TypePolitique>(politique), param,
+                                                      rappel != nullptr ? transmettre_cycle : nullptr, &rappel_c);
+        if (resultats != nullptr)
+        {
+            resultats->cycles = resultats_cpp.cycles;
+            resultats->deplacements = resultats_cpp.deplacements;
+            for (int i = 0; resultats->attente != nullptr && i < nb_files; ++i)
+            {
+                resultats->attente[i] = resultats_cpp.attente[i];
+            }
+        }
+        return TELEPORTEUR_OK;
+    }
+    catch (const bad_alloc &)
+    {
+        return TELEPORTEUR_ERREUR_MEMOIRE;
+    }
+    catch (...) // Aucune exception ne doit traverser l'interface C
+    {
+        return TELEPORTEUR_ERREUR_INTERNE;
+    }
+}
+
+extern "C" const char *teleporteur_message(int code)
+{
+    switch (code)
+    {
+    case TELEPORTEUR_OK:
+        return "";
+    case TELEPORTEUR_ERREUR_POLITIQUE:
+        return "Error: unknown policy";
+    case TELEPORTEUR_ERREUR_NB_FILES:
+        return "Error: the number of queues must be strictly positive";
+    case TELEPORTEUR_ERREUR_FILES:
+        return "Error: invalid queue index";
+    case TELEPORTEUR_ERREUR_MEMOIRE:
+        return "Error: out of memory";
+    case TELEPORTEUR_ERREUR_INTERNE:
+        return "Error: internal error";
+    }
+    return "Error: unknown error";
+}
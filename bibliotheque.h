@@ -0,0 +1,33 @@
+#ifndef BIBLIOTHEQUE_H
+#define BIBLIOTHEQUE_H
+
+#include "teleporteur.h"
+#include "tampon_sortie.h"
+
+#include <string>
+
+namespace teleporteur {
+
+// **Utilisation comme bibliothèque**
+// La bibliothèque regroupe tous les fichiers sauf main.cpp, bench.cpp,
+// relecture.cpp et verification.cpp ; les moteurs ne lisent et n'écrivent que
+// ce qu'on leur passe.
+// Un programme peut donc simuler ses scénarios sans processus ni texte
+// intermédiaire : emprunter_files() puis simuler_avec_rappel(), ou
+// simuler_politique() et les autres fonctions de teleporteur.h. teleporteur_c.h
+// donne la même chose en C.
+
+// Fait pointer param sur des files en mémoire de l'appelant, disposées comme dans
+// Parametres (debuts : nb_files + 1 positions croissantes à partir de 0), sans
+// copie : la mémoire doit rester valable tant que param sert. Rend le message
+// d'erreur de verifier_parametres(), vide si les files sont valides.
+std::string emprunter_files(int nb_files, const int* debuts, const int* destinations, Parametres& param);
+
+// Simule une politique ; rappel, s'il n'est pas nul, reçoit chaque cycle (la trace
+// SHOW_CYCLES sans le texte), sinon le moteur le plus rapide est utilisé.
+Resultats simuler_avec_rappel(TypePolitique politique, const Parametres& param, RappelCycle rappel = nullptr,
+                              void* contexte = nullptr, Quantiles quantiles = Quantiles::aucun);
+
+} // teleporteur
+
+#endif
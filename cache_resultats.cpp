@@ -0,0 +1,143 @@
+#include "cache_resultats.h"
+#include "texte_entree.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+#include <unistd.h>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace teleporteur
+{
+
+    static const char MAGIE[8] = {'T', 'E', 'L', 'E', 'C', 'A', 'C', '2'};
+
+    // Après l'en-tête : attentes (double) puis le scénario lui-même, numéros du mode
+    // creux (int64), debuts et destinations (int32). Une collision d'empreinte donne
+    // alors un scénario différent, pris pour une absence d'entrée.
+
+    struct EnteteCache
+    {
+        char magie[8];
+        uint32_t politique;
+        uint32_t reserve;
+        uint64_t empreinte;
+        uint64_t nb_files;
+        uint64_t nb_robots;
+        uint64_t nb_numeros;
+        int64_t cycles;
+        int64_t deplacements;
+    };
+    static_assert(sizeof(EnteteCache) % 8 == 0, "les attentes suivent l'en-tête alignées sur 8 octets");
+
+    // Rien à écrire : data() d'un tableau vide peut être nul, interdit pour fwrite
+    template <class T>
+    static bool ecrire(FILE *fichier, const T *valeurs, size_t nb)
+    {
+        return nb == 0 || fwrite(valeurs, sizeof(T), nb, fichier) == nb;
+    }
+
+    CacheResultats::CacheResultats(const string &dossier) : dossier(dossier)
+    {
+        error_code erreur;
+        fs::create_directories(dossier, erreur);
+        utilisable = fs::is_directory(dossier, erreur);
+    }
+
+    string CacheResultats::chemin(uint64_t empreinte, TypePolitique politique) const
+    {
+        char nom[32];
+        snprintf(nom, sizeof(nom), "%016llx.%d", static_cast<unsigned long long>(empreinte),
+                 static_cast<int>(politique));
+        return (fs::path(dossier) / nom).string();
+    }
+
+    bool CacheResultats::chercher(const Parametres &param, uint64_t empreinte, TypePolitique politique,
+                                  Resultats &resultats) const
+    {
+        TexteEntree fichier; // Projection mémoire de l'entrée
+        if (!utilisable || !fichier.charger_fichier(chemin(empreinte, politique)))
+        {
+            return false;
+        }
+        size_t taille = fichier.fin() - fichier.debut();
+        EnteteCache entete;
+        size_t nb_files = param.nb_files;
+        size_t nb_robots = param.destinations.size();
+        size_t nb_numeros = param.numeros.size();
+        if (taille != sizeof(entete) + nb_files * sizeof(double) + nb_numeros * sizeof(long long) +
+                          (nb_files + 1 + nb_robots) * sizeof(int))
+        {
+            return false;
+        }
+        memcpy(&entete, fichier.debut(), sizeof(entete));
+        if (memcmp(entete.magie, MAGIE, sizeof(MAGIE)) != 0 ||
+            entete.politique != static_cast<uint32_t>(politique) || entete.empreinte != empreinte ||
+            entete.nb_files != nb_files || entete.nb_robots != nb_robots || entete.nb_numeros != nb_numeros)
+        {
+            return false;
+        }
+        const char *scenario = fichier.debut() + sizeof(entete) + nb_files * sizeof(double);
+        if ((nb_numeros > 0 && memcmp(scenario, param.numeros.data(), nb_numeros * sizeof(long long)) != 0) ||
+            memcmp(scenario + nb_numeros * sizeof(long long), param.debuts.data(), (nb_files + 1) * sizeof(int)) != 0 ||
+            (nb_robots > 0 && memcmp(scenario + nb_numeros * sizeof(long long) + (nb_files + 1) * sizeof(int),
+                                     param.destinations.data(), nb_robots * sizeof(int)) != 0))
+        {
+            return false;
+        }
+        resultats = Resultats();
+        resultats.cycles = entete.cycles;
+        resultats.deplacements = entete.deplacements;
+        resultats.attente.resize(nb_files);
+        memcpy(resultats.attente.data(), fichier.debut() + sizeof(entete), nb_files * sizeof(double));
+        return true;
+    }
+
+    bool CacheResultats::ranger(const Parametres &param, uint64_t empreinte, TypePolitique politique,
+                                const Resultats &resultats) const
+    {
+        if (!utilisable || resultats.attente.size() != static_cast<size_t>(param.nb_files))
+        {
+            return false;
+        }
+        EnteteCache entete;
+        memset(&entete, 0, sizeof(entete));
+        memcpy(entete.magie, MAGIE, sizeof(MAGIE));
+        entete.politique = static_cast<uint32_t>(politique);
+        entete.empreinte = empreinte;
+        entete.nb_files = param.nb_files;
+        entete.nb_robots = param.destinations.size();
+        entete.nb_numeros = param.numeros.size();
+        entete.cycles = resultats.cycles;
+        entete.deplacements = resultats.deplacements;
+
+        // Un nom temporaire par processus et par écriture : jamais deux écrivains sur le même fichier
+        static atomic<unsigned long> numero_ecriture(0);
+        string definitif = chemin(empreinte, politique);
+        string temporaire = definitif + ".tmp." + to_string(getpid()) + "." + to_string(numero_ecriture++);
+        FILE *fichier = fopen(temporaire.c_str(), "wb");
+        if (fichier == nullptr)
+        {
+            return false;
+        }
+        bool ok = fwrite(&entete, sizeof(entete), 1, fichier) == 1 &&
+                  ecrire(fichier, resultats.attente.data(), resultats.attente.size()) &&
+                  ecrire(fichier, param.numeros.data(), param.numeros.size()) &&
+                  ecrire(fichier, param.debuts.data(), param.nb_files + 1) &&
+                  ecrire(fichier, param.destinations.data(), param.destinations.size());
+        // Sur le disque avant le renommage : après une panne, l'entrée est complète ou absente
+        ok = ok && fflush(fichier) == 0 && fsync(fileno(fichier)) == 0;
+        ok = (fclose(fichier) == 0) && ok;
+        if (!ok || rename(temporaire.c_str(), definitif.c_str()) != 0)
+        {
+            remove(temporaire.c_str());
+            return false;
+        }
+        return true;
+    }
+
+} // teleporteur
@@ -0,0 +1,43 @@
+#ifndef CACHE_RESULTATS_H
+#define CACHE_RESULTATS_H
+
+#include "teleporteur.h"
+
+#include <cstdint>
+#include <string>
+
+namespace teleporteur {
+
+// **Cache de résultats sur disque**
+// Un fichier par scénario et par politique, nommé d'après empreinte_parametres()
+// (nombre de files, files après lecture, numéros du mode creux) : deux scénarios
+// qui ne diffèrent que par leur type d'affichage partagent leurs entrées. Une
+// entrée garde ce que rend stocker_resultats() (cycles, déplacements, attentes
+// moyennes), pas les esquisses de quantiles, suivi du scénario normalisé, comparé
+// à la lecture : une collision d'empreinte ne rend jamais les résultats d'un autre
+// scénario. Elle est écrite dans un fichier temporaire propre à l'écrivain,
+// synchronisée sur le disque, puis renommée : des fils ou des processus
+// peuvent remplir le même cache sans verrou, et un lecteur voit une entrée
+// complète ou aucune. La lecture projette l'entrée en mémoire.
+class CacheResultats
+{
+public:
+    explicit CacheResultats(const std::string& dossier);
+    bool valide() const { return utilisable; }     // Faux si le dossier ne peut pas être créé
+
+    // Faux si l'entrée manque ou si le scénario qu'elle garde n'est pas param
+    bool chercher(const Parametres& param, std::uint64_t empreinte, TypePolitique politique,
+                  Resultats& resultats) const;
+    bool ranger(const Parametres& param, std::uint64_t empreinte, TypePolitique politique,
+                const Resultats& resultats) const;
+
+private:
+    std::string chemin(std::uint64_t empreinte, TypePolitique politique) const;
+
+    std::string dossier;
+    bool utilisable;
+};
+
+} // teleporteur
+
+#endif
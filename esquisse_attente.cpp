@@ -0,0 +1,68 @@
+#include "esquisse_attente.h"
+
+#include <cmath>
+
+using namespace std;
+
+namespace teleporteur
+{
+
+    // Les attentes croissent avec le temps : on prévoit une puissance de 2 de plus
+    // pour ne pas réallouer à chaque nouvelle case
+    void EsquisseAttente::grandir(size_t c)
+    {
+        size_t taille = c + 1 + (size_t(1) << BITS_SOUS_CASES);
+        comptes.resize(taille < NB_CASES ? taille : NB_CASES, 0);
+    }
+
+    void EsquisseAttente::fusionner(const EsquisseAttente &autre)
+    {
+        if (autre.comptes.size() > comptes.size())
+        {
+            comptes.resize(autre.comptes.size(), 0);
+        }
+        for (size_t c = 0; c < autre.comptes.size(); ++c)
+        {
+            comptes[c] += autre.comptes[c];
+        }
+        nb += autre.nb;
+        if (autre.plus_grande > plus_grande)
+        {
+            plus_grande = autre.plus_grande;
+        }
+    }
+
+    long long EsquisseAttente::milieu_de_case(size_t c)
+    {
+        if (c < (2u << BITS_SOUS_CASES))
+        {
+            return static_cast<long long>(c);
+        }
+        int decalage = static_cast<int>(c >> BITS_SOUS_CASES) - 1;
+        uint64_t debut = static_cast<uint64_t>(c - (static_cast<size_t>(decalage) << BITS_SOUS_CASES)) << decalage;
+        return static_cast<long long>(debut + ((uint64_t(1) << decalage) - 1) / 2);
+    }
+
+    // Plus petite valeur dont le rang atteint ceil(q * nombre()), comme un quantile exact
+    long long EsquisseAttente::quantile(double q) const
+    {
+        if (nb == 0)
+        {
+            return 0;
+        }
+        long long rang = static_cast<long long>(ceil(q * static_cast<double>(nb)));
+        rang = rang < 1 ? 1 : (rang > nb ? nb : rang);
+        long long cumul = 0;
+        for (size_t c = 0; c < comptes.size(); ++c)
+        {
+            cumul += comptes[c];
+            if (cumul >= rang)
+            {
+                long long valeur = milieu_de_case(c);
+                return valeur < plus_grande ? valeur : plus_grande;
+            }
+        }
+        return plus_grande;
+    }
+
+} // teleporteur
@@ -0,0 +1,64 @@
+#ifndef ESQUISSE_ATTENTE_H
+#define ESQUISSE_ATTENTE_H
+
+#include <cstdint>
+#include <vector>
+
+namespace teleporteur {
+
+// **Esquisse de la distribution des attentes**
+// Histogramme log-linéaire à la HDR : les valeurs de 0 à 15 ont chacune leur case,
+// au-delà chaque puissance de 2 est coupée en 8 cases égales. Un quantile est donc
+// connu à 1/16 près (milieu de sa case), le maximum exactement. Ajouter une valeur
+// coûte un count-leading-zeros et une incrémentation ; la mémoire ne dépend que de
+// la plus grande valeur vue (au plus 488 cases), pas du nombre de valeurs. Deux
+// esquisses se fusionnent case à case : l'esquisse globale d'une politique est la
+// fusion de celles de ses files.
+class EsquisseAttente
+{
+public:
+    void ajouter(long long valeur)
+    {
+        std::size_t c = case_de(valeur);
+        if (c >= comptes.size())
+        {
+            grandir(c);
+        }
+        ++comptes[c];
+        ++nb;
+        if (valeur > plus_grande)
+        {
+            plus_grande = valeur;
+        }
+    }
+    void fusionner(const EsquisseAttente& autre);
+
+    long long nombre() const { return nb; }
+    long long maximum() const { return plus_grande; }
+    long long quantile(double q) const;                 // q dans [0, 1] ; 0 si l'esquisse est vide
+
+private:
+    static const int BITS_SOUS_CASES = 3;              // 8 cases par puissance de 2
+    static const std::size_t NB_CASES = (64 - BITS_SOUS_CASES) << BITS_SOUS_CASES; // 488
+
+    static std::size_t case_de(long long valeur)
+    {
+        std::uint64_t v = valeur < 0 ? 0 : static_cast<std::uint64_t>(valeur);
+        if (v < (2u << BITS_SOUS_CASES))
+        {
+            return v;
+        }
+        int decalage = 63 - __builtin_clzll(v) - BITS_SOUS_CASES;
+        return (static_cast<std::size_t>(decalage) << BITS_SOUS_CASES) + (v >> decalage);
+    }
+    static long long milieu_de_case(std::size_t c);
+    void grandir(std::size_t c);
+
+    std::vector<long long> comptes;
+    long long nb = 0;
+    long long plus_grande = 0;
+};
+
+} // teleporteur
+
+#endif
@@ -0,0 +1,409 @@
+#include "flux_arrivees.h"
+#include "instrumentation.h"
+#include "lecture_texte.h"
+#include "politiques.h"
+#include "tampon_sortie.h"
+
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+#include <unistd.h>
+
+using namespace std;
+
+namespace teleporteur
+{
+
+    static const string BAD_ARRIVAL("Error: invalid queue index");
+    static const string BAD_ARRIVAL_CYCLE("Error: arrival cycles must be non-negative and non-decreasing");
+    static const string BAD_READ("Error: cannot read arrivals");
+
+    // Le jeton entier doit être un nombre
+    static bool lire_nombre(string_view jeton, long long &valeur)
+    {
+        const char *p = jeton.data();
+        const char *fin = p + jeton.size();
+        return lire_entier(p, fin, valeur) && p == fin;
+    }
+
+    FluxArrivees::FluxArrivees(int descripteur, TamponSortie *a_vider, size_t capacite)
+        : descripteur(descripteur), a_vider(a_vider), tampon(capacite < 64 ? 64 : capacite)
+    {
+    }
+
+    FluxArrivees::~FluxArrivees()
+    {
+        if (lecteur.joinable())
+        {
+            anneau->arreter();
+            lecteur.join();
+        }
+    }
+
+    // Garde le texte pas encore lu au début du tampon et lit la suite derrière
+    bool FluxArrivees::remplir()
+    {
+        if (termine)
+        {
+            return false;
+        }
+        if (debut > 0)
+        {
+            memmove(tampon.data(), tampon.data() + debut, fin - debut);
+            fin -= debut;
+            debut = 0;
+        }
+        if (fin == tampon.size())
+        {
+            tampon.resize(tampon.size() * 2); // Un seul jeton remplit tout le tampon
+        }
+        if (a_vider != nullptr && !anneau) // En parallèle, a_vider appartient au fil de la simulation
+        {
+            a_vider->vider();
+        }
+        while (true)
+        {
+            ssize_t n = read(descripteur, tampon.data() + fin, tampon.size() - fin);
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (n <= 0)
+            {
+                if (n < 0)
+                {
+                    message = BAD_READ;
+                }
+                termine = true;
+                return false;
+            }
+            fin += n;
+            return true;
+        }
+    }
+
+    // Le jeton pointe dans le tampon : il reste valable jusqu'à l'appel suivant
+    bool FluxArrivees::lire_jeton(string_view &jeton)
+    {
+        while (true)
+        {
+            while (debut < fin && est_blanc(tampon[debut]))
+            {
+                ++debut;
+            }
+            if (debut < fin)
+            {
+                break;
+            }
+            if (!remplir())
+            {
+                return false;
+            }
+        }
+        size_t longueur = 0;
+        while (true)
+        {
+            while (debut + longueur < fin && !est_blanc(tampon[debut + longueur]))
+            {
+                ++longueur;
+            }
+            if (debut + longueur < fin || !remplir())
+            {
+                break;
+            }
+        }
+        jeton = string_view(tampon.data() + debut, longueur);
+        debut += longueur;
+        return true;
+    }
+
+    bool FluxArrivees::lire_entete(Parametres &param)
+    {
+        string_view jeton;
+        param.affichage_type = lire_jeton(jeton) ? string(jeton) : string();
+        long long nombre;
+        if (!lire_jeton(jeton) || !lire_nombre(jeton, nombre) || nombre < 0 || nombre > INT_MAX)
+        {
+            nombre = 0;
+        }
+        param.nb_files = static_cast<int>(nombre);
+        param.destinations.clear();
+        param.debuts.assign(param.nb_files + 1, 0);
+        nb_files = param.nb_files;
+        return verifier_parametres(param, false).empty();
+    }
+
+    void FluxArrivees::lire_en_parallele(size_t capacite)
+    {
+        anneau.reset(new AnneauSpsc<Arrivee>(capacite));
+        lecteur = thread([this]
+                         {
+                             Arrivee arrivee;
+                             while (lire_arrivee(arrivee) && anneau->pousser(arrivee))
+                             {
+                             }
+                             anneau->fermer(); // Publie aussi message
+                         });
+    }
+
+    bool FluxArrivees::suivante(Arrivee &arrivee)
+    {
+        if (!anneau)
+        {
+            return lire_arrivee(arrivee);
+        }
+        if (a_vider != nullptr && !anneau->pret())
+        {
+            a_vider->vider();
+        }
+        return anneau->retirer(&arrivee, 1) == 1;
+    }
+
+    bool FluxArrivees::lire_arrivee(Arrivee &arrivee)
+    {
+        if (fin_du_flux)
+        {
+            return false;
+        }
+        string_view jeton;
+        long long valeurs[3];
+        for (int i = 0; i < 3; ++i)
+        {
+            if (!lire_jeton(jeton))
+            {
+                // Fin du texte entre deux arrivées : fin normale du flux
+                if (i > 0 && message.empty())
+                {
+                    message = BAD_ARRIVAL;
+                }
+                fin_du_flux = true;
+                return false;
+            }
+            if (!lire_nombre(jeton, valeurs[i]))
+            {
+                message = BAD_ARRIVAL;
+                fin_du_flux = true;
+                return false;
+            }
+        }
+        if (valeurs[0] == -1 && valeurs[1] == -1 && valeurs[2] == -1)
+        {
+            fin_du_flux = true;
+            return false;
+        }
+        if (valeurs[1] < 0 || valeurs[1] >= nb_files || valeurs[2] < 0 || valeurs[2] >= nb_files)
+        {
+            message = BAD_ARRIVAL;
+            fin_du_flux = true;
+            return false;
+        }
+        if (valeurs[0] < dernier_cycle)
+        {
+            message = BAD_ARRIVAL_CYCLE;
+            fin_du_flux = true;
+            return false;
+        }
+        dernier_cycle = valeurs[0];
+        arrivee.cycle = valeurs[0];
+        arrivee.file = static_cast<int>(valeurs[1]);
+        arrivee.destination = static_cast<int>(valeurs[2]);
+        return true;
+    }
+
+    // **Robots en attente**
+    // Une liste chaînée par file dans une réserve de maillons commune ; les maillons
+    // des robots chargés sont réutilisés, la réserve ne dépasse donc jamais le plus
+    // grand nombre de robots en attente en même temps.
+    struct MaillonRobot
+    {
+        long long arrivee;
+        int destination;
+        int suivant;
+    };
+
+    struct FilesEnAttente
+    {
+        vector<MaillonRobot> maillons;
+        vector<int> tetes, queues;
+        int libre = -1;
+
+        void initialiser(int nb_files)
+        {
+            tetes.assign(nb_files, -1);
+            queues.assign(nb_files, -1);
+        }
+        bool vide(int file) const { return tetes[file] == -1; }
+        const MaillonRobot &tete(int file) const { return maillons[tetes[file]]; }
+        void ajouter(int file, int destination, long long arrivee)
+        {
+            int m = libre;
+            if (m == -1)
+            {
+                m = static_cast<int>(maillons.size());
+                maillons.push_back(MaillonRobot());
+            }
+            else
+            {
+                libre = maillons[m].suivant;
+            }
+            maillons[m] = MaillonRobot{arrivee, destination, -1};
+            if (tetes[file] == -1)
+            {
+                tetes[file] = m;
+            }
+            else
+            {
+                maillons[queues[file]].suivant = m;
+            }
+            queues[file] = m;
+        }
+        void retirer(int file)
+        {
+            int m = tetes[file];
+            tetes[file] = maillons[m].suivant;
+            maillons[m].suivant = libre;
+            libre = m;
+        }
+    };
+
+    // **Moteur en flux**
+    // Le cycle de simuler<Politique>() (teleporteur.cpp), précédé de l'entrée des
+    // robots arrivés au plus tard au cycle qui commence.
+    template <class Politique>
+    static bool simuler_flux(const Parametres &param, Politique &politique, FluxArrivees &flux,
+                             TamponSortie *trace, Resultats &resultats, CompteursMoteur *compteurs,
+                             Quantiles quantiles)
+    {
+        long long cycles = 0, deplacements = 0;
+        int scanner = 0, robot_dans_scanner = -1;
+        vector<long long> somme_attentes(param.nb_files, 0), nb_robots(param.nb_files, 0);
+        FilesEnAttente files;
+        files.initialiser(param.nb_files);
+        IndexOccupation non_vides;
+        non_vides.initialiser(param.nb_files);
+        politique.initialiser(param, non_vides);
+        EsquissesMoteur esquisses(quantiles, param.nb_files);
+
+        Arrivee prochaine;
+        bool en_attente = flux.suivante(prochaine);
+        while (true)
+        {
+            while (en_attente && prochaine.cycle <= cycles + 1)
+            {
+                files.ajouter(prochaine.file, prochaine.destination, prochaine.cycle);
+                ++nb_robots[prochaine.file];
+                if (!non_vides.contient(prochaine.file))
+                {
+                    non_vides.marquer(prochaine.file);
+                    politique.apres_arrivee(prochaine.file);
+                }
+                en_attente = flux.suivante(prochaine);
+            }
+            // En parallèle, le lecteur écrit le message jusqu'à ce que suivante() rende faux
+            if (!en_attente && !flux.erreur().empty())
+            {
+                return false; // Inutile de continuer : le flux est rejeté
+            }
+            if (non_vides.vide() && robot_dans_scanner == -1)
+            {
+                if (!en_attente)
+                {
+                    break;
+                }
+                cycles = prochaine.cycle - 1; // Scanner au repos jusqu'à la prochaine arrivée
+                continue;
+            }
+
+            politique.debut_cycle(non_vides);
+            bool sortie = (robot_dans_scanner != -1);
+            int depart = scanner;
+            ++cycles;
+            if (!files.vide(depart) && politique.peut_charger(depart))
+            {
+                const MaillonRobot &robot = files.tete(depart);
+                robot_dans_scanner = robot.destination;
+                somme_attentes[depart] += cycles - robot.arrivee;
+                esquisses.ajouter(depart, cycles - robot.arrivee);
+                files.retirer(depart);
+                if (files.vide(depart))
+                {
+                    non_vides.effacer(depart);
+                }
+                politique.apres_chargement(depart, !files.vide(depart));
+                scanner = robot_dans_scanner;
+                deplacements += abs(depart - scanner);
+                compter_cycle(compteurs, sortie, true, abs(depart - scanner));
+                afficher_cycle(trace, cycles, depart, scanner, sortie, true);
+            }
+            else
+            {
+                robot_dans_scanner = -1;
+                int prochaine_file = politique.prochaine_file(depart, non_vides);
+                if (prochaine_file != -1)
+                {
+                    scanner = prochaine_file;
+                    deplacements += abs(depart - scanner);
+                }
+                compter_cycle(compteurs, sortie, false, abs(depart - scanner));
+                afficher_cycle(trace, cycles, depart, scanner, sortie, false);
+            }
+        }
+
+        resultats.cycles = cycles;
+        resultats.deplacements = deplacements;
+        esquisses.ranger(resultats);
+        resultats.attente.resize(param.nb_files);
+        for (int i = 0; i < param.nb_files; ++i)
+        {
+            resultats.attente[i] = nb_robots[i] > 0 ? static_cast<double>(somme_attentes[i]) / nb_robots[i] : 0.0;
+        }
+        return true;
+    }
+
+    bool simuler_flux(TypePolitique politique, const Parametres &param, FluxArrivees &flux, TamponSortie *trace,
+                      Resultats &resultats, CompteursMoteur *compteurs, Quantiles quantiles)
+    {
+        if (!INSTRUMENTATION_COMPILEE)
+        {
+            compteurs = nullptr;
+        }
+        Chronometre chronometre;
+        bool ok = false;
+        switch (politique)
+        {
+        case TypePolitique::neqli:
+        {
+            PolitiqueNeqli neqli;
+            ok = simuler_flux(param, neqli, flux, trace, resultats, compteurs, quantiles);
+            break;
+        }
+        case TypePolitique::faneqli:
+        {
+            PolitiqueFaneqli faneqli;
+            ok = simuler_flux(param, faneqli, flux, trace, resultats, compteurs, quantiles);
+            break;
+        }
+        case TypePolitique::sstf:
+        {
+            PolitiqueSstf sstf;
+            ok = simuler_flux(param, sstf, flux, trace, resultats, compteurs, quantiles);
+            break;
+        }
+        case TypePolitique::scan:
+        {
+            PolitiqueScan scan;
+            ok = simuler_flux(param, scan, flux, trace, resultats, compteurs, quantiles);
+            break;
+        }
+        }
+        if (compteurs != nullptr)
+        {
+            compteurs->secondes += chronometre.secondes();
+        }
+        return ok;
+    }
+
+} // teleporteur
@@ -0,0 +1,78 @@
+#ifndef FLUX_ARRIVEES_H
+#define FLUX_ARRIVEES_H
+
+#include "teleporteur.h"
+#include "anneau_spsc.h"
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace teleporteur {
+
+class TamponSortie;
+struct CompteursMoteur;
+
+// **Arrivée d'un robot en mode flux**
+struct Arrivee {
+    long long cycle;                   // Premier cycle où le robot peut être chargé
+    int file;
+    int destination;
+};
+
+// **Lecture d'un flux d'arrivées**
+// Même en-tête que les scénarios (type d'affichage puis nombre de files), suivi de
+// triplets « cycle file destination » aux cycles croissants, terminés par
+// -1 -1 -1 ou par la fin du texte. Le texte est lu par blocs au fur et à mesure :
+// la mémoire ne dépend pas de la longueur du flux. a_vider, s'il n'est pas nul,
+// est vidé avant chaque lecture qui peut bloquer, pour que la trace déjà calculée
+// sorte sans attendre la suite du flux.
+// Après lire_en_parallele(), un autre fil lit et analyse le texte pendant la
+// simulation et passe les arrivées par un anneau ; a_vider est alors vidé quand
+// l'anneau est vide, juste avant d'attendre.
+class FluxArrivees
+{
+public:
+    explicit FluxArrivees(int descripteur, TamponSortie* a_vider = nullptr, std::size_t capacite = 1 << 20);
+    ~FluxArrivees();
+
+    bool lire_entete(Parametres& param);           // affichage_type et nb_files ; faux si illisible
+    void lire_en_parallele(std::size_t capacite = 1 << 14); // Après lire_entete(), avant suivante()
+    bool suivante(Arrivee& arrivee);               // Faux à la fin du flux ou sur erreur
+    const std::string& erreur() const { return message; } // Vide sauf après une erreur ; après que suivante() a rendu faux
+
+private:
+    bool lire_arrivee(Arrivee& arrivee);
+    bool lire_jeton(std::string_view& jeton);      // Faux en fin de texte
+    bool remplir();                                // Faux en fin de texte
+
+    int descripteur;
+    TamponSortie* a_vider;
+    std::vector<char> tampon;
+    std::size_t debut = 0, fin = 0;                // Texte pas encore lu : tampon[debut, fin)
+    bool termine = false;                          // Plus rien à lire dans le descripteur
+    bool fin_du_flux = false;                      // -1 -1 -1, fin du texte ou erreur
+    int nb_files = 0;
+    long long dernier_cycle = 0;
+    std::string message;
+    std::unique_ptr<AnneauSpsc<Arrivee>> anneau;   // Lecture en parallèle seulement
+    std::thread lecteur;
+};
+
+// **Simulation en flux**
+// Les robots entrent dans leur file au cycle indiqué par leur arrivée, pendant que la
+// simulation avance ; seuls les robots en attente sont en mémoire. L'attente d'un
+// robot compte depuis son arrivée : un flux où tous les robots arrivent au cycle 0
+// donne les mêmes résultats et la même trace que le scénario équivalent. Quand il
+// n'y a plus rien à faire avant la prochaine arrivée, le scanner attend sur place :
+// ces cycles sont comptés mais n'apparaissent pas dans la trace.
+// Faux si le flux contient une erreur ; le message est alors dans flux.erreur().
+bool simuler_flux(TypePolitique politique, const Parametres& param, FluxArrivees& flux, TamponSortie* trace,
+                  Resultats& resultats, CompteursMoteur* compteurs = nullptr,
+                  Quantiles quantiles = Quantiles::aucun);
+
+} // teleporteur
+
+#endif
@@ -0,0 +1,178 @@
+#include "generateur.h"
+#include "teleporteur.h"
+#include "arene.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+
+using namespace std;
+
+namespace teleporteur
+{
+
+    static const char *const NOMS_CHARGES[] = {"uniforme", "zipf", "auto", "zero", "ping_pong"};
+
+    const char *nom_charge(TypeCharge type)
+    {
+        return NOMS_CHARGES[static_cast<int>(type)];
+    }
+
+    bool lire_charge(const string &nom, TypeCharge &type)
+    {
+        for (int i = 0; i < 5; ++i)
+        {
+            if (nom == NOMS_CHARGES[i])
+            {
+                type = static_cast<TypeCharge>(i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // **Tirages reproductibles (splitmix64), identiques sur toutes les plateformes**
+    class Tirage
+    {
+    public:
+        explicit Tirage(uint64_t graine) : etat(graine) {}
+
+        uint64_t suivant()
+        {
+            uint64_t z = (etat += 0x9e3779b97f4a7c15ULL);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            return z ^ (z >> 31);
+        }
+        int entier(int borne) // Uniforme dans [0, borne)
+        {
+            return static_cast<int>((static_cast<unsigned __int128>(suivant()) * borne) >> 64);
+        }
+        double reel() // Uniforme dans [0, 1)
+        {
+            return (suivant() >> 11) * (1.0 / 9007199254740992.0);
+        }
+
+    private:
+        uint64_t etat;
+    };
+
+    // Loi de puissance continue tronquée à [1, n + 1), ramenée à [0, n)
+    static int tirer_zipf(Tirage &tirage, int n, double exposant)
+    {
+        double u = tirage.reel();
+        double x;
+        if (fabs(exposant - 1.0) < 1e-9)
+        {
+            x = pow(n + 1.0, u);
+        }
+        else
+        {
+            double a = 1.0 - exposant;
+            x = pow((pow(n + 1.0, a) - 1.0) * u + 1.0, 1.0 / a);
+        }
+        int indice = static_cast<int>(x) - 1;
+        return indice < 0 ? 0 : (indice >= n ? n - 1 : indice);
+    }
+
+    static void tirer_robot(const DescriptionCharge &charge, Tirage &tirage, int &file, int &sortie)
+    {
+        int n = charge.nb_files;
+        switch (charge.type)
+        {
+        case TypeCharge::uniforme:
+            file = tirage.entier(n);
+            sortie = tirage.entier(n);
+            break;
+        case TypeCharge::zipf:
+            file = tirer_zipf(tirage, n, charge.exposant_zipf);
+            sortie = tirer_zipf(tirage, n, charge.exposant_zipf);
+            break;
+        case TypeCharge::auto_routee:
+            file = tirage.entier(n);
+            sortie = file;
+            break;
+        case TypeCharge::vers_zero:
+            file = tirage.entier(n);
+            sortie = 0;
+            break;
+        case TypeCharge::ping_pong:
+            file = tirage.entier(n);
+            sortie = file < n / 2 ? n - 1 : 0;
+            break;
+        }
+    }
+
+    // Deux tirages avec la même graine : comptage des robots de chaque file, puis
+    // rangement. debuts a nb_files + 1 cases, positions nb_files.
+    static void remplir_files(const DescriptionCharge &charge, int *debuts, int *destinations, int *positions)
+    {
+        fill(debuts, debuts + charge.nb_files + 1, 0);
+        int file, sortie;
+
+        Tirage comptage(charge.graine);
+        for (long long r = 0; r < charge.nb_robots; ++r)
+        {
+            tirer_robot(charge, comptage, file, sortie);
+            ++debuts[file + 1];
+        }
+        for (int i = 0; i < charge.nb_files; ++i)
+        {
+            debuts[i + 1] += debuts[i];
+        }
+
+        copy(debuts, debuts + charge.nb_files, positions);
+        Tirage rangement(charge.graine);
+        for (long long r = 0; r < charge.nb_robots; ++r)
+        {
+            tirer_robot(charge, rangement, file, sortie);
+            destinations[positions[file]++] = sortie;
+        }
+    }
+
+    void generer_parametres(const DescriptionCharge &charge, Parametres &param)
+    {
+        param.affichage_type = "SHOW_NO_CYCLE";
+        param.nb_files = charge.nb_files;
+        param.numeros.clear();
+        param.debuts.resize(charge.nb_files + 1);
+        param.destinations.resize(charge.nb_robots);
+        vector<int> positions(charge.nb_files);
+        remplir_files(charge, param.debuts.modifier(), param.destinations.modifier(), positions.data());
+    }
+
+    void generer_parametres(const DescriptionCharge &charge, Parametres &param, Arene &arene)
+    {
+        param.affichage_type = "SHOW_NO_CYCLE";
+        param.nb_files = charge.nb_files;
+        param.numeros.clear();
+        int *debuts = arene.allouer<int>(charge.nb_files + 1);
+        int *destinations = arene.allouer<int>(charge.nb_robots);
+        int *positions = arene.allouer<int>(charge.nb_files);
+        remplir_files(charge, debuts, destinations, positions);
+        param.debuts.emprunter(debuts, charge.nb_files + 1);
+        param.destinations.emprunter(destinations, charge.nb_robots);
+    }
+
+    string generer_texte(const DescriptionCharge &charge, const string &affichage_type)
+    {
+        string texte = affichage_type + "\n" + to_string(charge.nb_files) + "\n";
+        texte.reserve(texte.size() + charge.nb_robots * 14 + 8);
+        Tirage tirage(charge.graine);
+        char ligne[48];
+        int file, sortie;
+        for (long long r = 0; r < charge.nb_robots; ++r)
+        {
+            tirer_robot(charge, tirage, file, sortie);
+            // Un int tient en 11 caractères : les deux nombres et leurs séparateurs tiennent dans ligne
+            char *p = to_chars(ligne, ligne + 12, file).ptr;
+            *p = ' ';
+            p = to_chars(p + 1, p + 13, sortie).ptr;
+            *p = '\n';
+            texte.append(ligne, p + 1);
+        }
+        texte += "-1 -1\n";
+        return texte;
+    }
+
+} // teleporteur
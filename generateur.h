@@ -0,0 +1,42 @@
+#ifndef GENERATEUR_H
+#define GENERATEUR_H
+
+#include <cstdint>
+#include <string>
+
+namespace teleporteur {
+
+struct Parametres;
+class Arene;
+
+// **Charges synthétiques**
+// uniforme   : files et sorties tirées uniformément
+// zipf       : files et sorties concentrées sur les petits indices (loi de Zipf)
+// auto       : chaque robot sort par sa propre file
+// zero       : tous les robots sortent par la file 0
+// ping_pong  : les robots des petites files vont à la dernière, les autres à la file 0
+enum class TypeCharge { uniforme, zipf, auto_routee, vers_zero, ping_pong };
+
+struct DescriptionCharge {
+    TypeCharge type = TypeCharge::uniforme;
+    int nb_files = 1;
+    long long nb_robots = 0;
+    std::uint64_t graine = 1;
+    double exposant_zipf = 1.1;
+};
+
+const char* nom_charge(TypeCharge type);
+bool lire_charge(const std::string& nom, TypeCharge& type);
+
+// Remplit directement les files à plat de param (deux tirages avec la même graine :
+// comptage puis rangement), sans passer par le texte
+void generer_parametres(const DescriptionCharge& charge, Parametres& param);
+// Le même scénario rangé dans l'arène, que param emprunte : aucune allocation une
+// fois l'arène assez grande. param ne sert plus après arene.vider().
+void generer_parametres(const DescriptionCharge& charge, Parametres& param, Arene& arene);
+// Le même scénario au format de l'entrée standard
+std::string generer_texte(const DescriptionCharge& charge, const std::string& affichage_type);
+
+} // teleporteur
+
+#endif
@@ -0,0 +1,57 @@
+#include "instrumentation.h"
+#include "tampon_sortie.h"
+
+using namespace std;
+
+namespace teleporteur
+{
+
+    static void ecrire_tableau(const long long *valeurs, int nb, TamponSortie &sortie)
+    {
+        sortie.ecrire('[');
+        for (int i = 0; i < nb; ++i)
+        {
+            if (i > 0)
+            {
+                sortie.ecrire(',');
+            }
+            sortie.ecrire_entier(valeurs[i]);
+        }
+        sortie.ecrire(']');
+    }
+
+    // **Rapport JSON**
+    // L'histogramme s'arrête à la dernière classe non vide.
+    void afficher_instrumentation_json(const Instrumentation &instrumentation, TamponSortie &sortie)
+    {
+        sortie.ecrire("{\"instrumentation\":");
+        sortie.ecrire(INSTRUMENTATION_COMPILEE ? "true" : "false");
+        sortie.ecrire(",\n \"phases\":{\"lecture\":");
+        sortie.ecrire_decimal(instrumentation.lecture, 6);
+        sortie.ecrire(",\"sortie\":");
+        sortie.ecrire_decimal(instrumentation.sortie, 6);
+        sortie.ecrire("},\n \"politiques\":[");
+        for (size_t p = 0; p < instrumentation.compteurs.size(); ++p)
+        {
+            const CompteursMoteur &compteurs = instrumentation.compteurs[p];
+            sortie.ecrire(p > 0 ? ",\n  {\"nom\":\"" : "\n  {\"nom\":\"");
+            sortie.ecrire(instrumentation.politiques[p]);
+            sortie.ecrire("\",\"simulation\":");
+            sortie.ecrire_decimal(compteurs.secondes, 6);
+            sortie.ecrire(",\"cas\":");
+            ecrire_tableau(compteurs.cas, 4, sortie);
+            sortie.ecrire(",\"deplacements_a_vide\":");
+            sortie.ecrire_entier(compteurs.deplacements_a_vide);
+            int nb_classes = CompteursMoteur::NB_CLASSES;
+            while (nb_classes > 0 && compteurs.histogramme_sauts[nb_classes - 1] == 0)
+            {
+                --nb_classes;
+            }
+            sortie.ecrire(",\"histogramme_sauts\":");
+            ecrire_tableau(compteurs.histogramme_sauts, nb_classes, sortie);
+            sortie.ecrire('}');
+        }
+        sortie.ecrire("]}\n");
+    }
+
+} // teleporteur
@@ -0,0 +1,91 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace teleporteur {
+
+class TamponSortie;
+
+// **Compteurs d'un moteur de simulation**
+// Remplis par simuler_politique() quand on lui passe un CompteursMoteur non nul.
+// Les cas sont ceux de l'énoncé, d'après l'état du scanner au début du cycle :
+//   cas 1 : scanner vide, pas de chargement (déplacement à vide ou attente)
+//   cas 2 : scanner vide, chargement
+//   cas 3 : déchargement sans reprise, puis déplacement à vide
+//   cas 4 : déchargement et chargement dans le même cycle
+// histogramme_sauts[0] compte les sauts de longueur 0, histogramme_sauts[b] ceux
+// de longueur 2^(b-1) à 2^b - 1.
+// Compiler avec -DTELEPORTEUR_SANS_INSTRUMENTATION retire tous les appels des moteurs.
+struct CompteursMoteur {
+    static const int NB_CLASSES = 65;
+
+    long long cas[4] = {};
+    long long deplacements_a_vide = 0;     // Déplacements du scanner sans robot
+    long long histogramme_sauts[NB_CLASSES] = {};
+    double secondes = 0;                   // Durée de la simulation
+
+    void compter_cycle(int numero_cas, long long nb = 1) { cas[numero_cas - 1] += nb; }
+    void compter_saut(long long distance, long long nb = 1)
+    {
+        int classe = distance == 0 ? 0 : 64 - __builtin_clzll(static_cast<unsigned long long>(distance));
+        histogramme_sauts[classe] += nb;
+    }
+};
+
+#ifdef TELEPORTEUR_SANS_INSTRUMENTATION
+const bool INSTRUMENTATION_COMPILEE = false;
+#else
+const bool INSTRUMENTATION_COMPILEE = true;
+#endif
+
+// Points d'appel des moteurs : ne font rien si compteurs est nul, et disparaissent
+// à la compilation sans instrumentation.
+inline void compter_cycle(CompteursMoteur* compteurs, bool sortie, bool entree, long long distance)
+{
+    if (INSTRUMENTATION_COMPILEE && compteurs != nullptr)
+    {
+        compteurs->compter_cycle(entree ? (sortie ? 4 : 2) : (sortie ? 3 : 1));
+        if (entree)
+        {
+            compteurs->compter_saut(distance);
+        }
+        else if (distance != 0)
+        {
+            ++compteurs->deplacements_a_vide;
+            compteurs->compter_saut(distance);
+        }
+    }
+}
+
+// **Chronomètre sur horloge monotone**
+class Chronometre
+{
+public:
+    Chronometre() : debut(std::chrono::steady_clock::now()) {}
+    double secondes() const
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - debut).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point debut;
+};
+
+// **Rapport d'instrumentation d'une exécution**
+// Durées des phases communes et compteurs de chaque politique simulée.
+struct Instrumentation {
+    double lecture = 0;                    // Lecture et validation du scénario
+    double sortie = 0;                     // Formatage et écriture des résultats
+    std::vector<std::string> politiques;   // Nom de chaque politique, dans l'ordre de compteurs
+    std::vector<CompteursMoteur> compteurs;
+};
+
+// Un objet JSON sur plusieurs lignes, terminé par un saut de ligne
+void afficher_instrumentation_json(const Instrumentation& instrumentation, TamponSortie& sortie);
+
+} // teleporteur
+
+#endif
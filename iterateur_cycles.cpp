@@ -0,0 +1,99 @@
+#include "iterateur_cycles.h"
+#include "politiques.h"
+
+using namespace std;
+
+namespace teleporteur
+{
+
+    // Cache le type de la politique : un appel virtuel par cycle, comme un rappel de trace
+    class MoteurIterable
+    {
+    public:
+        virtual ~MoteurIterable() = default;
+        virtual bool suivant(CycleSimule &cycle) = 0;
+        virtual bool termine() const = 0;
+        virtual long long cycles() const = 0;
+        virtual Resultats resultats() = 0;
+    };
+
+    template <class Politique>
+    class MoteurPolitique : public MoteurIterable
+    {
+    public:
+        MoteurPolitique(const Parametres &param, Quantiles quantiles) : moteur(param, quantiles) {}
+
+        bool suivant(CycleSimule &cycle) override
+        {
+            if (moteur.termine())
+            {
+                return false;
+            }
+            PasMoteur pas = moteur.avancer();
+            cycle.cycle = moteur.cycles;
+            cycle.depart = moteur.param.numero(pas.depart);
+            cycle.arrivee = moteur.param.numero(moteur.scanner);
+            cycle.distance = pas.distance;
+            cycle.sortie = pas.sortie;
+            cycle.entree = pas.entree;
+            return true;
+        }
+        bool termine() const override { return moteur.termine(); }
+        long long cycles() const override { return moteur.cycles; }
+        Resultats resultats() override
+        {
+            while (!moteur.termine())
+            {
+                moteur.avancer();
+            }
+            return moteur.resultats();
+        }
+
+    private:
+        MoteurCycles<Politique> moteur;
+    };
+
+    IterateurCycles::IterateurCycles(TypePolitique politique, const Parametres &param, Quantiles quantiles)
+    {
+        switch (politique)
+        {
+        case TypePolitique::neqli:
+            moteur.reset(new MoteurPolitique<PolitiqueNeqli>(param, quantiles));
+            break;
+        case TypePolitique::faneqli:
+            moteur.reset(new MoteurPolitique<PolitiqueFaneqli>(param, quantiles));
+            break;
+        case TypePolitique::sstf:
+            moteur.reset(new MoteurPolitique<PolitiqueSstf>(param, quantiles));
+            break;
+        case TypePolitique::scan:
+            moteur.reset(new MoteurPolitique<PolitiqueScan>(param, quantiles));
+            break;
+        }
+    }
+
+    IterateurCycles::~IterateurCycles() = default;
+    IterateurCycles::IterateurCycles(IterateurCycles &&) noexcept = default;
+    IterateurCycles &IterateurCycles::operator=(IterateurCycles &&) noexcept = default;
+
+    bool IterateurCycles::suivant(CycleSimule &cycle)
+    {
+        return moteur->suivant(cycle);
+    }
+
+    bool IterateurCycles::termine() const
+    {
+        return moteur->termine();
+    }
+
+    long long IterateurCycles::cycles() const
+    {
+        return moteur->cycles();
+    }
+
+    Resultats IterateurCycles::resultats()
+    {
+        return moteur->resultats();
+    }
+
+} // teleporteur
@@ -0,0 +1,49 @@
+#ifndef ITERATEUR_CYCLES_H
+#define ITERATEUR_CYCLES_H
+
+#include "teleporteur.h"
+
+#include <memory>
+
+namespace teleporteur {
+
+// **Cycle rendu par IterateurCycles**
+struct CycleSimule {
+    long long cycle;                   // À partir de 1
+    long long depart;                  // Numéros de file, comme dans la trace
+    long long arrivee;
+    long long distance;                // Déplacement du scanner pendant le cycle
+    bool sortie;
+    bool entree;
+};
+
+class MoteurIterable;
+
+// **Simulation à la demande**
+// Joue un cycle à chaque appel de suivant() et le rend, au lieu de tout écrire
+// dans une trace : on peut s'arrêter quand on veut, n'examiner qu'une partie des
+// cycles, passer directement aux statistiques avec resultats() ou faire avancer
+// plusieurs politiques en alternance. Rien n'est gardé des cycles déjà rendus et
+// toute la mémoire est allouée à la construction. Mêmes cycles que la trace
+// SHOW_CYCLES et mêmes résultats que simuler_politique(). param doit rester
+// valable tant que l'itérateur sert.
+class IterateurCycles
+{
+public:
+    IterateurCycles(TypePolitique politique, const Parametres& param, Quantiles quantiles = Quantiles::aucun);
+    ~IterateurCycles();
+    IterateurCycles(IterateurCycles&&) noexcept;
+    IterateurCycles& operator=(IterateurCycles&&) noexcept;
+
+    bool suivant(CycleSimule& cycle);              // Faux quand tous les robots sont livrés
+    bool termine() const;
+    long long cycles() const;                      // Cycles déjà joués
+    Resultats resultats();                         // Joue sans les rendre les cycles qui restent
+
+private:
+    std::unique_ptr<MoteurIterable> moteur;
+};
+
+} // teleporteur
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef LECTURE_TEXTE_H
+#define LECTURE_TEXTE_H
+
+#include <climits>
+#include <string>
+
+// Lecture des mots et des entiers d'un texte en mémoire ; en-tête interne, partagé
+// par la lecture des scénarios (teleporteur.cpp) et celle des flux d'arrivées.
+
+namespace teleporteur {
+
+// **Lecture rapide du texte d'entrée**
+// Mêmes règles que cin >> : blancs ignorés, signe optionnel puis chiffres.
+inline bool est_blanc(char c)
+{
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+inline const char* sauter_blancs(const char* p, const char* fin)
+{
+    while (p != fin && est_blanc(*p))
+    {
+        ++p;
+    }
+    return p;
+}
+
+inline std::string lire_mot(const char*& p, const char* fin)
+{
+    p = sauter_blancs(p, fin);
+    const char* debut = p;
+    while (p != fin && !est_blanc(*p))
+    {
+        ++p;
+    }
+    return std::string(debut, p);
+}
+
+// Faux sans chiffre ou si la valeur ne tient pas dans un long long ; p est alors
+// quelque part dans le nombre, l'appelant abandonne la lecture.
+inline bool lire_entier(const char*& p, const char* fin, long long& valeur)
+{
+    p = sauter_blancs(p, fin);
+    bool negatif = false;
+    if (p != fin && (*p == '-' || *p == '+'))
+    {
+        negatif = (*p == '-');
+        ++p;
+    }
+    const char* chiffres = p;
+    unsigned long long v = 0;
+    while (p != fin && static_cast<unsigned char>(*p - '0') < 10)
+    {
+        if (v > (ULLONG_MAX - 9) / 10)
+        {
+            return false;
+        }
+        v = v * 10 + (*p - '0');
+        ++p;
+    }
+    if (p == chiffres || v > static_cast<unsigned long long>(LLONG_MAX) + negatif)
+    {
+        return false;
+    }
+    valeur = negatif ? static_cast<long long>(0 - v) : static_cast<long long>(v);
+    return true;
+}
+
+} // teleporteur
+
+#endif
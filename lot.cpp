@@ -0,0 +1,292 @@
+#include "lot.h"
+#include "cache_resultats.h"
+#include "point_reprise.h"
+#include "reserve_fils.h"
+#include "tampon_sortie.h"
+#include "teleporteur.h"
+#include "texte_entree.h"
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <new>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace teleporteur
+{
+
+    bool lister_scenarios(const string &chemin, vector<string> &scenarios)
+    {
+        error_code erreur;
+        if (fs::is_directory(chemin, erreur))
+        {
+            for (const auto &entree : fs::directory_iterator(chemin, erreur))
+            {
+                if (entree.is_regular_file(erreur))
+                {
+                    scenarios.push_back(entree.path().string());
+                }
+            }
+            sort(scenarios.begin(), scenarios.end());
+            return !erreur;
+        }
+
+        ifstream manifeste(chemin);
+        if (!manifeste)
+        {
+            return false;
+        }
+        fs::path dossier = fs::path(chemin).parent_path();
+        string ligne;
+        while (getline(manifeste, ligne))
+        {
+            ligne.erase(0, ligne.find_first_not_of(" \t\r"));
+            ligne.erase(ligne.find_last_not_of(" \t\r") + 1);
+            if (ligne.empty() || ligne[0] == '#')
+            {
+                continue;
+            }
+            fs::path scenario(ligne);
+            scenarios.push_back(scenario.is_absolute() ? ligne : (dossier / scenario).string());
+        }
+        return true;
+    }
+
+    // **Une ligne par scénario : les valeurs de afficher_statistiques_finales() séparées par des tabulations**
+    // scénario, cycles NEQLI et FANEQLI, déplacements NEQLI et FANEQLI, puis les
+    // deux attentes moyennes de chaque file (vides quand elles valent 0)
+    void afficher_statistiques_ligne(const string &scenario, const Resultats &resultats_neqli,
+                                     const Resultats &resultats_faneqli, TamponSortie &sortie)
+    {
+        sortie.ecrire(scenario);
+        for (long long valeur : {resultats_neqli.cycles, resultats_faneqli.cycles,
+                                 resultats_neqli.deplacements, resultats_faneqli.deplacements})
+        {
+            sortie.ecrire('\t');
+            sortie.ecrire_entier(valeur);
+        }
+        for (size_t i = 0; i < resultats_neqli.attente.size(); ++i)
+        {
+            for (double attente : {resultats_neqli.attente[i], resultats_faneqli.attente[i]})
+            {
+                sortie.ecrire('\t');
+                if (attente != 0)
+                {
+                    sortie.ecrire_decimal(attente, 2);
+                }
+            }
+        }
+        sortie.ecrire('\n');
+    }
+
+    static void ecrire_chaine_json(const string &texte, TamponSortie &sortie)
+    {
+        static const char hexa[] = "0123456789abcdef";
+        sortie.ecrire('"');
+        for (unsigned char c : texte)
+        {
+            if (c == '"' || c == '\\')
+            {
+                sortie.ecrire('\\');
+                sortie.ecrire(static_cast<char>(c));
+            }
+            else if (c < 0x20)
+            {
+                char echappe[] = {'\\', 'u', '0', '0', hexa[c >> 4], hexa[c & 15]};
+                sortie.ecrire(echappe, sizeof(echappe));
+            }
+            else
+            {
+                sortie.ecrire(static_cast<char>(c));
+            }
+        }
+        sortie.ecrire('"');
+    }
+
+    static void ecrire_resultats_json(const Resultats &resultats, TamponSortie &sortie)
+    {
+        sortie.ecrire("{\"cycles\":");
+        sortie.ecrire_entier(resultats.cycles);
+        sortie.ecrire(",\"deplacements\":");
+        sortie.ecrire_entier(resultats.deplacements);
+        sortie.ecrire(",\"attente\":[");
+        for (size_t i = 0; i < resultats.attente.size(); ++i)
+        {
+            if (i > 0)
+            {
+                sortie.ecrire(',');
+            }
+            if (resultats.attente[i] != 0)
+            {
+                sortie.ecrire_decimal(resultats.attente[i], 2);
+            }
+            else
+            {
+                sortie.ecrire("null"); // File vide au départ
+            }
+        }
+        sortie.ecrire("]}");
+    }
+
+    // **Variante JSON (une ligne par scénario)**
+    void afficher_statistiques_json(const string &scenario, const Resultats &resultats_neqli,
+                                    const Resultats &resultats_faneqli, TamponSortie &sortie)
+    {
+        sortie.ecrire("{\"scenario\":");
+        ecrire_chaine_json(scenario, sortie);
+        sortie.ecrire(",\"neqli\":");
+        ecrire_resultats_json(resultats_neqli, sortie);
+        sortie.ecrire(",\"faneqli\":");
+        ecrire_resultats_json(resultats_faneqli, sortie);
+        sortie.ecrire("}\n");
+    }
+
+    static void afficher_erreur_lot(const string &scenario, const string &message, FormatLot format,
+                                    TamponSortie &sortie)
+    {
+        if (format == FormatLot::json)
+        {
+            sortie.ecrire("{\"scenario\":");
+            ecrire_chaine_json(scenario, sortie);
+            sortie.ecrire(",\"erreur\":");
+            ecrire_chaine_json(message, sortie);
+            sortie.ecrire("}\n");
+        }
+        else
+        {
+            sortie.ecrire(scenario);
+            sortie.ecrire('\t');
+            sortie.ecrire(message);
+            sortie.ecrire('\n');
+        }
+    }
+
+    // Résultats du cache s'il les a, sinon simulés puis rangés dans le cache
+    static Resultats resultats_politique(TypePolitique politique, const Parametres &param, uint64_t empreinte,
+                                         const CacheResultats *cache)
+    {
+        Resultats resultats;
+        if (cache != nullptr && cache->chercher(param, empreinte, politique, resultats))
+        {
+            return resultats;
+        }
+        resultats = simuler_politique(politique, param, nullptr);
+        if (cache != nullptr)
+        {
+            cache->ranger(param, empreinte, politique, resultats);
+        }
+        return resultats;
+    }
+
+    // Simule un scénario et rend sa ligne de résultats ; faux en cas d'erreur
+    static bool traiter_scenario(const string &scenario, FormatLot format, const CacheResultats *cache,
+                                 string &ligne)
+    {
+        TamponSortie texte(nullptr, 256);
+        TexteEntree entree;
+        Parametres param;
+        bool error_trouve = false;
+        string message;
+        if (!entree.charger_fichier(scenario))
+        {
+            message = "Error: cannot read scenario";
+        }
+        else
+        {
+            analyser_parametres(entree.debut(), entree.fin(), param, error_trouve);
+            message = verifier_parametres(param, error_trouve);
+        }
+
+        bool ok = message.empty();
+        if (ok)
+        {
+            uint64_t empreinte = cache != nullptr ? empreinte_parametres(param) : 0;
+            Resultats resultats_neqli = resultats_politique(TypePolitique::neqli, param, empreinte, cache);
+            Resultats resultats_faneqli = resultats_politique(TypePolitique::faneqli, param, empreinte, cache);
+            if (format == FormatLot::json)
+            {
+                afficher_statistiques_json(scenario, resultats_neqli, resultats_faneqli, texte);
+            }
+            else
+            {
+                afficher_statistiques_ligne(scenario, resultats_neqli, resultats_faneqli, texte);
+            }
+        }
+        else
+        {
+            afficher_erreur_lot(scenario, message, format, texte);
+        }
+        ligne = texte.texte();
+        return ok;
+    }
+
+    // Ligne d'erreur d'un scénario dont le traitement a levé une exception : le lot continue
+    static string ligne_exception(const string &scenario, FormatLot format)
+    {
+        string message;
+        try
+        {
+            throw;
+        }
+        catch (const bad_alloc &)
+        {
+            message = "Error: out of memory";
+        }
+        catch (...)
+        {
+            message = "Error: internal error";
+        }
+        TamponSortie texte(nullptr, 256);
+        afficher_erreur_lot(scenario, message, format, texte);
+        return texte.texte();
+    }
+
+    int executer_lot(const vector<string> &scenarios, FormatLot format, unsigned nb_fils,
+                     TamponSortie &sortie, const CacheResultats *cache)
+    {
+        // Les lignes terminées attendent ici que toutes les précédentes soient écrites
+        vector<string> lignes(scenarios.size());
+        vector<char> pretes(scenarios.size(), 0);
+        size_t prochaine = 0;
+        mutex verrou_sortie;
+        atomic<int> nb_erreurs(0);
+
+        ReserveFils reserve(nb_fils);
+        for (size_t i = 0; i < scenarios.size(); ++i)
+        {
+            reserve.soumettre([&, i] {
+                string ligne;
+                bool ok;
+                try
+                {
+                    ok = traiter_scenario(scenarios[i], format, cache, ligne);
+                }
+                catch (...)
+                {
+                    ok = false;
+                    ligne = ligne_exception(scenarios[i], format);
+                }
+                if (!ok)
+                {
+                    ++nb_erreurs;
+                }
+                lock_guard<mutex> garde(verrou_sortie);
+                lignes[i] = move(ligne);
+                pretes[i] = 1;
+                while (prochaine < scenarios.size() && pretes[prochaine])
+                {
+                    sortie.ecrire(lignes[prochaine]);
+                    string().swap(lignes[prochaine]);
+                    ++prochaine;
+                }
+            });
+        }
+        reserve.attendre();
+        sortie.vider();
+        return nb_erreurs;
+    }
+
+} // teleporteur
@@ -0,0 +1,35 @@
+#ifndef LOT_H
+#define LOT_H
+
+#include <string>
+#include <vector>
+
+namespace teleporteur {
+
+class TamponSortie;
+class CacheResultats;
+struct Resultats;
+
+// **Exécution par lots**
+// Chaque scénario (un fichier au format de l'entrée standard) passe par NEQLI
+// puis FANEQLI sur un fil de la réserve ; une ligne de statistiques est écrite
+// par scénario, dans l'ordre de la liste, dès que les précédentes sont prêtes.
+enum class FormatLot { texte, json };
+
+// Fichiers d'un dossier (triés) ou lignes d'un manifeste (vides et # ignorées,
+// chemins relatifs au dossier du manifeste)
+bool lister_scenarios(const std::string& chemin, std::vector<std::string>& scenarios);
+
+void afficher_statistiques_ligne(const std::string& scenario, const Resultats& resultats_neqli,
+ const Resultats& resultats_faneqli, TamponSortie& sortie);
+void afficher_statistiques_json(const std::string& scenario, const Resultats& resultats_neqli,
+ const Resultats& resultats_faneqli, TamponSortie& sortie);
+
+// Rend le nombre de scénarios en erreur ; cache, s'il n'est pas nul, évite de
+// simuler à nouveau les scénarios déjà vus
+int executer_lot(const std::vector<std::string>& scenarios, FormatLot format, unsigned nb_fils,
+ TamponSortie& sortie, const CacheResultats* cache = nullptr);
+
+} // teleporteur
+
+#endif
@@ -1,28 +1,429 @@
 #include "teleporteur.h"
+#include "tampon_sortie.h"
+#include "lot.h"
+#include "flux_arrivees.h"
+#include "point_reprise.h"
+#include "instrumentation.h"
+#include "multi_scanners.h"
+#include "trace_parallele.h"
+#include "trace_binaire.h"
+#include "iterateur_cycles.h"
+#include "cache_resultats.h"
 
-#include <iostream>
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 using namespace teleporteur;
-using namespace std;
+
+static int usage(const char* programme) {
+	std::fprintf(stderr, "Usage : %s [--politiques neqli,faneqli,sstf,scan] [--quantiles|--quantiles-files] [--instrumentation] [--creux] [--pipeline|--trace-binaire PREFIXE|--limite-trace N] [--cache DOSSIER] < scenario\n"
+	                     "        %s [--points-reprise PREFIXE] [--intervalle-reprise CYCLES] [--reprise PREFIXE] < scenario\n"
+	                     "        %s --scanners K [--politiques neqli,faneqli] [--quantiles|--quantiles-files] [--creux] < scenario\n"
+	                     "        %s --flux [--politiques POLITIQUE] [--quantiles|--quantiles-files] [--instrumentation] [--pipeline|--trace-binaire PREFIXE] < arrivees\n"
+	                     "        %s --lot DOSSIER|MANIFESTE [--json] [--fils N] [--cache DOSSIER]\n", programme, programme, programme, programme, programme);
+	return 1;
+}
+
+// Fichier propre à une politique (points de reprise, trace binaire) : PREFIXE.neqli, PREFIXE.faneqli...
+static std::string fichier_politique(const std::string& prefixe, TypePolitique politique) {
+	std::string nom = nom_politique(politique);
+	for (char& c : nom) {
+		c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+	}
+	return prefixe + "." + nom;
+}
+
+// **Mode lot : une ligne de statistiques par scénario**
+static int main_lot(const std::string& chemin, FormatLot format, unsigned nb_fils, const CacheResultats* cache) {
+	std::vector<std::string> scenarios;
+	if (!lister_scenarios(chemin, scenarios)) {
+		std::fprintf(stderr, "Impossible de lire %s\n", chemin.c_str());
+		return 1;
+	}
+	return executer_lot(scenarios, format, nb_fils, sortie_standard(), cache) == 0 ? 0 : 2;
+}
+
+// **Mode flux : les robots arrivent pendant la simulation d'une seule politique**
+// Avec pipeline, la lecture du flux et l'écriture de la trace ont chacune leur fil.
+// Avec une trace binaire, les cycles vont dans PREFIXE.politique au lieu de la sortie.
+static int main_flux(TypePolitique politique, bool instrumenter, Quantiles quantiles, bool pipeline,
+                     const std::string& trace_binaire) {
+	TamponSortie& sortie = sortie_standard();
+	Instrumentation instrumentation;
+	instrumentation.politiques.push_back(nom_politique(politique));
+	instrumentation.compteurs.resize(1);
+
+	Parametres param;
+	// En pipeline, seul le fil de la trace écrit dans sortie pendant la simulation
+	FluxArrivees flux(0, pipeline ? nullptr : &sortie);
+	if (!flux.lire_entete(param)) {
+		error(param, false, sortie);
+		return 0;
+	}
+	bool avec_trace = param.affichage_type == "SHOW_CYCLES";
+	if (!trace_binaire.empty() && !avec_trace) {
+		std::fprintf(stderr, "La trace binaire ne s'applique qu'aux scénarios SHOW_CYCLES\n");
+		return 1;
+	}
+	std::vector<Resultats> resultats(1);
+	bool flux_valide;
+	if (!trace_binaire.empty()) {
+		std::string chemin = fichier_politique(trace_binaire, politique);
+		EcrivainTraceBinaire trace(chemin);
+		flux_valide = simuler_flux(politique, param, flux, trace.tampon(), resultats[0],
+		                           instrumenter ? &instrumentation.compteurs[0] : nullptr, quantiles);
+		if (!trace.terminer()) {
+			std::fprintf(stderr, "Impossible d'écrire %s\n", chemin.c_str());
+		}
+	} else if (pipeline) {
+		flux.lire_en_parallele();
+		std::unique_ptr<TraceParallele> trace(avec_trace ? new TraceParallele(sortie, true) : nullptr);
+		flux_valide = simuler_flux(politique, param, flux, trace ? trace->tampon() : nullptr, resultats[0],
+		                           instrumenter ? &instrumentation.compteurs[0] : nullptr, quantiles);
+	} else {
+		flux_valide = simuler_flux(politique, param, flux, avec_trace ? &sortie : nullptr, resultats[0],
+		                           instrumenter ? &instrumentation.compteurs[0] : nullptr, quantiles);
+	}
+	if (!flux_valide) {
+		print_error(flux.erreur(), sortie);
+		return 0;
+	}
+	Chronometre chrono_sortie;
+	afficher_statistiques_finales(resultats, sortie);
+	if (quantiles != Quantiles::aucun) {
+		afficher_quantiles(resultats, sortie);
+	}
+	sortie.vider();
+	instrumentation.sortie = chrono_sortie.secondes();
+
+	if (instrumenter) {
+		TamponSortie rapport(stderr);
+		afficher_instrumentation_json(instrumentation, rapport);
+	}
+	return 0;
+}
+
+// **Plusieurs scanners sur les mêmes files : une politique après l'autre, K fils chacune**
+static int main_scanners(const std::vector<TypePolitique>& politiques, int nb_scanners, Quantiles quantiles,
+                        bool creux) {
+	Parametres param;
+	bool error_trouve = false;
+	TamponSortie& sortie = sortie_standard();
+	lire_et_valider_parametres(param, error_trouve, creux);
+	if (error(param, error_trouve, sortie)) {
+		return 0;
+	}
+	if (param.affichage_type == "SHOW_CYCLES") {
+		std::fprintf(stderr, "Plusieurs scanners : pas de trace des cycles, scénarios SHOW_NO_CYCLE seulement\n");
+		return 1;
+	}
+	afficher_etat_initial(param, sortie);
+	std::vector<ResultatsScanners> resultats(politiques.size());
+	std::vector<Resultats> totaux;
+	for (size_t p = 0; p < politiques.size(); ++p) {
+		simuler_scanners(politiques[p], param, nb_scanners, resultats[p], quantiles);
+		totaux.push_back(std::move(resultats[p].total));
+	}
+	afficher_statistiques_finales(totaux, sortie, &param);
+	if (quantiles != Quantiles::aucun) {
+		afficher_quantiles(totaux, sortie, &param);
+	}
+	afficher_statistiques_scanners(resultats, sortie);
+	sortie.vider();
+	return 0;
+}
+
+// **Points de reprise**
+struct PointsReprise {
+	std::vector<EtatSimulation> departs;
+	std::vector<std::unique_ptr<EcrivainPointsReprise>> ecrivains;
+	std::vector<Reprise> reprises;
+};
+
+// Une politique sans fichier de reprise part du cycle 0 ; un fichier illisible ou
+// écrit pour un autre scénario est une erreur.
+static bool preparer_reprises(const Parametres& param, const std::vector<TypePolitique>& politiques,
+                              const std::string& ecriture, const std::string& lecture, long long intervalle,
+                              PointsReprise& points, TamponSortie& sortie) {
+	std::uint64_t empreinte = empreinte_parametres(param);
+	points.departs.resize(politiques.size());
+	points.ecrivains.resize(politiques.size());
+	points.reprises.resize(politiques.size());
+	for (size_t p = 0; p < politiques.size(); ++p) {
+		points.reprises[p].empreinte = empreinte;
+		if (!lecture.empty()) {
+			std::string chemin = fichier_politique(lecture, politiques[p]);
+			std::FILE* fichier = std::fopen(chemin.c_str(), "rb");
+			if (fichier != nullptr) {
+				std::fclose(fichier);
+				std::string message = lire_point_reprise(chemin, points.departs[p])
+				                          ? verifier_point_reprise(points.departs[p], param, politiques[p], empreinte)
+				                          : "Error: cannot read checkpoint " + chemin;
+				if (!message.empty()) {
+					print_error(message, sortie);
+					return false;
+				}
+				points.reprises[p].depart = &points.departs[p];
+			}
+		}
+		if (!ecriture.empty()) {
+			points.ecrivains[p].reset(new EcrivainPointsReprise(fichier_politique(ecriture, politiques[p]), intervalle));
+			points.reprises[p].ecrivain = points.ecrivains[p].get();
+		}
+	}
+	return true;
+}
+
+// Liste de politiques séparées par des virgules, chacune au plus une fois : une
+// politique répétée écrirait deux fois les mêmes fichiers (points de reprise, trace binaire)
+static bool lire_politiques(const std::string& liste, std::vector<TypePolitique>& politiques) {
+	politiques.clear();
+	size_t debut = 0;
+	while (debut <= liste.size()) {
+		size_t fin = liste.find(',', debut);
+		if (fin == std::string::npos) {
+			fin = liste.size();
+		}
+		TypePolitique politique;
+		if (!lire_politique(liste.substr(debut, fin - debut), politique) ||
+		    std::find(politiques.begin(), politiques.end(), politique) != politiques.end()) {
+			return false;
+		}
+		politiques.push_back(politique);
+		debut = fin + 1;
+	}
+	return true;
+}
 
 // **Fonction principale**
-int main() {
+int main(int argc, char* argv[]) {
+	std::string lot;
+	FormatLot format = FormatLot::texte;
+	unsigned nb_fils = 0;
+	std::vector<TypePolitique> politiques = {TypePolitique::neqli, TypePolitique::faneqli};
+	bool instrumenter = false;
+	Quantiles quantiles = Quantiles::aucun;
+	bool flux = false;
+	bool politiques_choisies = false;
+	std::string points_reprise, reprise;
+	long long intervalle_reprise = 100000000;
+	int nb_scanners = 0;
+	bool creux = false;
+	bool pipeline = false;
+	std::string trace_binaire;
+	long long limite_trace = -1;
+	std::string dossier_cache;
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--lot") == 0 && i + 1 < argc) {
+			lot = argv[++i];
+		} else if (std::strcmp(argv[i], "--json") == 0) {
+			format = FormatLot::json;
+		} else if (std::strcmp(argv[i], "--fils") == 0 && i + 1 < argc) {
+			nb_fils = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+		} else if (std::strcmp(argv[i], "--flux") == 0) {
+			flux = true;
+		} else if (std::strcmp(argv[i], "--quantiles") == 0) {
+			quantiles = Quantiles::global;
+		} else if (std::strcmp(argv[i], "--quantiles-files") == 0) {
+			quantiles = Quantiles::par_file;
+		} else if (std::strcmp(argv[i], "--points-reprise") == 0 && i + 1 < argc) {
+			points_reprise = argv[++i];
+		} else if (std::strcmp(argv[i], "--intervalle-reprise") == 0 && i + 1 < argc) {
+			intervalle_reprise = std::strtoll(argv[++i], nullptr, 10);
+		} else if (std::strcmp(argv[i], "--reprise") == 0 && i + 1 < argc) {
+			reprise = argv[++i];
+		} else if (std::strcmp(argv[i], "--scanners") == 0 && i + 1 < argc) {
+			nb_scanners = std::atoi(argv[++i]);
+			if (nb_scanners < 1 || nb_scanners > MAX_SCANNERS) {
+				return usage(argv[0]);
+			}
+		} else if (std::strcmp(argv[i], "--creux") == 0) {
+			creux = true;
+		} else if (std::strcmp(argv[i], "--pipeline") == 0) {
+			pipeline = true;
+		} else if (std::strcmp(argv[i], "--trace-binaire") == 0 && i + 1 < argc) {
+			trace_binaire = argv[++i];
+		} else if (std::strcmp(argv[i], "--cache") == 0 && i + 1 < argc) {
+			dossier_cache = argv[++i];
+		} else if (std::strcmp(argv[i], "--limite-trace") == 0 && i + 1 < argc) {
+			limite_trace = std::strtoll(argv[++i], nullptr, 10);
+			if (limite_trace < 0) {
+				return usage(argv[0]);
+			}
+		} else if (std::strcmp(argv[i], "--instrumentation") == 0) {
+			instrumenter = true;
+		} else if (std::strcmp(argv[i], "--politiques") == 0 && i + 1 < argc) {
+			if (!lire_politiques(argv[++i], politiques)) {
+				return usage(argv[0]);
+			}
+			politiques_choisies = true;
+		} else {
+			return usage(argv[0]);
+		}
+	}
+	bool avec_reprise = !points_reprise.empty() || !reprise.empty();
+	if (avec_reprise && (flux || quantiles != Quantiles::aucun)) {
+		return usage(argv[0]); // Ni le flux ni les esquisses ne sont dans les points de reprise
+	}
+	if (creux && (flux || !lot.empty())) {
+		return usage(argv[0]);
+	}
+	if ((pipeline || !trace_binaire.empty()) && (!lot.empty() || nb_scanners > 0)) {
+		return usage(argv[0]);
+	}
+	if (pipeline && !trace_binaire.empty()) {
+		return usage(argv[0]);
+	}
+	if (limite_trace >= 0 && (flux || !lot.empty() || nb_scanners > 0 || pipeline || !trace_binaire.empty() ||
+	                          instrumenter)) {
+		return usage(argv[0]);
+	}
+	// Le cache ne garde ni les esquisses, ni les compteurs, ni les états de reprise
+	std::unique_ptr<CacheResultats> cache;
+	if (!dossier_cache.empty()) {
+		if (flux || nb_scanners > 0 || avec_reprise || instrumenter || quantiles != Quantiles::aucun) {
+			return usage(argv[0]);
+		}
+		cache.reset(new CacheResultats(dossier_cache));
+		if (!cache->valide()) {
+			std::fprintf(stderr, "Impossible de créer le cache %s\n", dossier_cache.c_str());
+			return 1;
+		}
+	}
+	if (!lot.empty()) {
+		return main_lot(lot, format, nb_fils, cache.get());
+	}
+	if (nb_scanners > 0) {
+		if (flux || avec_reprise || instrumenter) {
+			return usage(argv[0]);
+		}
+		for (TypePolitique politique : politiques) {
+			if (!politique_multi_scanners(politique)) {
+				return usage(argv[0]);
+			}
+		}
+		return main_scanners(politiques, nb_scanners, quantiles, creux);
+	}
+	if (flux) {
+		// Le flux n'est lu qu'une fois : une seule politique, NEQLI par défaut
+		if (!politiques_choisies) {
+			politiques = {TypePolitique::neqli};
+		}
+		return politiques.size() == 1 ? main_flux(politiques[0], instrumenter, quantiles, pipeline, trace_binaire) : usage(argv[0]);
+	}
+
     Parametres param;
     bool error_trouve = false;
-	lire_et_valider_parametres(param, error_trouve);
-	error(param, error_trouve);
+    TamponSortie& sortie = sortie_standard();
+	Instrumentation instrumentation;
+	Chronometre chrono_lecture;
+	lire_et_valider_parametres(param, error_trouve, creux);
+	instrumentation.lecture = chrono_lecture.secondes();
+	if (error(param, error_trouve, sortie)) {
+		return 0;
+	}
+	if (!trace_binaire.empty() && param.affichage_type != "SHOW_CYCLES") {
+		std::fprintf(stderr, "La trace binaire ne s'applique qu'aux scénarios SHOW_CYCLES\n");
+		return 1;
+	}
+	PointsReprise points;
+	if (avec_reprise) {
+		if (param.affichage_type == "SHOW_CYCLES") {
+			std::fprintf(stderr, "Les points de reprise ne s'appliquent qu'aux scénarios SHOW_NO_CYCLE\n");
+			return 1;
+		}
+		if (!preparer_reprises(param, politiques, points_reprise, reprise, intervalle_reprise, points, sortie)) {
+			return 0;
+		}
+	}
+	auto reprise_de = [&](size_t p) { return avec_reprise ? &points.reprises[p] : nullptr; };
     
-    Parametres param1 = param;
     // Affichage de l'état initial des files
-    afficher_etat_initial(param);   
+    afficher_etat_initial(param, sortie);   
+    std::vector<Resultats> resultats(politiques.size());
+	instrumentation.compteurs.resize(politiques.size());
+	for (TypePolitique politique : politiques) {
+		instrumentation.politiques.push_back(nom_politique(politique));
+	}
+	// Compteurs nuls sans --instrumentation : les moteurs ne comptent rien
+	auto compteurs = [&](size_t p) { return instrumenter ? &instrumentation.compteurs[p] : nullptr; };
+	std::uint64_t empreinte = cache ? empreinte_parametres(param) : 0;
+	std::vector<char> en_cache(politiques.size(), 0);
     if (param.affichage_type == "SHOW_CYCLES"){
-		cout << "NEQLI" << endl;
+		// Les traces doivent sortir dans l'ordre : exécution l'une après l'autre
+		for (size_t p = 0; p < politiques.size(); ++p) {
+			sortie.ecrire(nom_politique(politiques[p]));
+			sortie.ecrire('\n');
+			if (limite_trace >= 0) {
+				// Les premiers cycles seulement ; le reste est joué sans trace
+				IterateurCycles iterateur(politiques[p], param, quantiles);
+				CycleSimule cycle;
+				for (long long n = 0; n < limite_trace && iterateur.suivant(cycle); ++n) {
+					afficher_cycle(&sortie, cycle.cycle, cycle.depart, cycle.arrivee, cycle.sortie, cycle.entree);
+				}
+				resultats[p] = iterateur.resultats();
+			} else if (!trace_binaire.empty()) {
+				std::string chemin = fichier_politique(trace_binaire, politiques[p]);
+				EcrivainTraceBinaire trace(chemin);
+				resultats[p] = simuler_politique(politiques[p], param, trace.tampon(), compteurs(p), quantiles);
+				if (!trace.terminer()) {
+					std::fprintf(stderr, "Impossible d'écrire %s\n", chemin.c_str());
+				}
+			} else if (pipeline) {
+				// Le moteur ne fait que remplir l'anneau ; un autre fil écrit le texte
+				TraceParallele trace(sortie);
+				resultats[p] = simuler_politique(politiques[p], param, trace.tampon(), compteurs(p), quantiles);
+			} else {
+				resultats[p] = simuler_politique(politiques[p], param, &sortie, compteurs(p), quantiles);
+			}
+		}
+	}
+	else {
+		// Sans trace, les politiques lisent les mêmes files en parallèle ; celles du cache ne sont pas simulées
+		std::vector<std::thread> fils;
+		for (size_t p = 0; p < politiques.size(); ++p) {
+			if (cache && cache->chercher(param, empreinte, politiques[p], resultats[p])) {
+				en_cache[p] = 1;
+				continue;
+			}
+			fils.emplace_back([&, p] { resultats[p] = simuler_politique(politiques[p], param, nullptr, compteurs(p), quantiles,
+			                                                                   reprise_de(p)); });
+		}
+		for (std::thread& fil : fils) {
+			fil.join();
+		}
+	}
+	for (size_t p = 0; cache && p < politiques.size(); ++p) {
+		if (!en_cache[p]) {
+			cache->ranger(param, empreinte, politiques[p], resultats[p]);
+		}
+	}
+	for (size_t p = 0; p < points.ecrivains.size(); ++p) {
+		if (points.ecrivains[p] && points.ecrivains[p]->erreur()) {
+			std::fprintf(stderr, "Impossible d'écrire %s\n", fichier_politique(points_reprise, politiques[p]).c_str());
+		}
+	}
+	Chronometre chrono_sortie;
+	afficher_statistiques_finales(resultats, sortie, &param);
+	if (quantiles != Quantiles::aucun) {
+		afficher_quantiles(resultats, sortie, &param);
+	}
+	sortie.vider();
+	instrumentation.sortie = chrono_sortie.secondes();
+
+	if (instrumenter) {
+		// Sur la sortie d'erreur, pour ne pas mêler le rapport aux statistiques
+		TamponSortie rapport(stderr);
+		afficher_instrumentation_json(instrumentation, rapport);
 	}
-    neqli(param);
-	if ( param.affichage_type == "SHOW_CYCLES"){
-		cout << "FANEQLI" << endl; }
-	faneqli(param1);
-	afficher_statistiques_finales();
 
     return 0;
 }
@@ -0,0 +1,298 @@
+#include "multi_scanners.h"
+#include "politiques.h"
+#include "tampon_sortie.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <utility>
+
+using namespace std;
+
+namespace teleporteur
+{
+
+    // **Barrière entre les fils des scanners**
+    // Attente active : une phase dure quelques dizaines de nanosecondes, bien moins
+    // qu'un réveil par le noyau. Un fil qui attend longtemps (cœurs partagés avec
+    // d'autres programmes) cède son cœur.
+    class Barriere
+    {
+    public:
+        explicit Barriere(int nb) : nb(nb) {}
+        void attendre()
+        {
+            unsigned tour = generation.load(memory_order_relaxed);
+            if (arrives.fetch_add(1, memory_order_acq_rel) + 1 == nb)
+            {
+                arrives.store(0, memory_order_relaxed);
+                generation.store(tour + 1, memory_order_release);
+                return;
+            }
+            for (int essais = 0; generation.load(memory_order_acquire) == tour;)
+            {
+                if (essais < 1000)
+                {
+                    ++essais;
+                }
+                else
+                {
+                    this_thread::yield();
+                }
+            }
+        }
+
+    private:
+        const int nb;
+        alignas(64) atomic<int> arrives{0};
+        alignas(64) atomic<unsigned> generation{0};
+    };
+
+    // **État d'un scanner**
+    // Sur sa propre ligne de cache : seul son fil l'écrit.
+    struct alignas(64) EtatScanner
+    {
+        int position = 0;
+        int robot = -1;                // Destination du robot chargé, -1 si le scanner est vide
+        bool veut_charger = false;
+        int repli = -1;                // File visée si le chargement n'a pas lieu
+        StatistiquesScanner statistiques;
+        EsquisseAttente esquisse;
+    };
+
+    // **État partagé par les scanners**
+    // Pendant la phase de décision, tout est en lecture seule sauf les réclamations.
+    // Pendant la phase d'application, une file n'est touchée que par le scanner qui
+    // l'a obtenue : curseur, somme des attentes et esquisse de la file.
+    struct Atelier
+    {
+        const Parametres &param;
+        CurseursFiles files;
+        IndexOccupation non_vides;
+        vector<atomic<uint64_t>> reclamations; // marque_de() du plus petit scanner qui réclame la file
+        vector<long long> somme_indices_cycles;
+        vector<EsquisseAttente> esquisses;
+        vector<EtatScanner> scanners;
+        Quantiles quantiles;
+        Barriere barriere;
+        long long cycles = 0;
+
+        Atelier(const Parametres &param, int nb_scanners, int nb_fils, Quantiles quantiles)
+            : param(param), reclamations(param.nb_files), somme_indices_cycles(param.nb_files, 0),
+              esquisses(quantiles == Quantiles::par_file ? param.nb_files : 0), scanners(nb_scanners),
+              quantiles(quantiles), barriere(nb_fils)
+        {
+            files.initialiser(param);
+            mettre_a_jour_files_non_vides(param, non_vides);
+        }
+
+        bool termine() const
+        {
+            if (!non_vides.vide())
+            {
+                return false;
+            }
+            for (const EtatScanner &scanner : scanners)
+            {
+                if (scanner.robot != -1)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        void reclamer(int file, uint64_t marque)
+        {
+            uint64_t actuelle = reclamations[file].load(memory_order_relaxed);
+            while (actuelle < marque && !reclamations[file].compare_exchange_weak(actuelle, marque, memory_order_relaxed))
+            {
+            }
+        }
+    };
+
+    // Réclamation d'une file au cycle donné : la plus grande marque gagne
+    static inline uint64_t marque_de(long long cycle, int numero)
+    {
+        return (static_cast<uint64_t>(cycle) << 16) | static_cast<uint64_t>(0xFFFF - numero);
+    }
+
+    // **Phase de décision d'un scanner**
+    template <class Politique>
+    static void decider(Atelier &atelier, int numero, Politique &politique, long long cycle)
+    {
+        EtatScanner &moi = atelier.scanners[numero];
+        politique.oublier_files_videes(atelier.non_vides);
+        politique.debut_cycle(atelier.non_vides);
+        moi.veut_charger = !atelier.files.vide(moi.position) && politique.peut_charger(moi.position);
+        if (moi.veut_charger)
+        {
+            atelier.reclamer(moi.position, marque_de(cycle, numero));
+        }
+        moi.repli = politique.prochaine_file(moi.position, atelier.non_vides);
+    }
+
+    // **Phase d'application d'un scanner**
+    template <class Politique>
+    static void appliquer(Atelier &atelier, int numero, Politique &politique, long long cycle)
+    {
+        EtatScanner &moi = atelier.scanners[numero];
+        int depart = moi.position;
+        if (moi.veut_charger && atelier.reclamations[depart].load(memory_order_relaxed) == marque_de(cycle, numero))
+        {
+            moi.robot = atelier.files.tete(depart);
+            atelier.somme_indices_cycles[depart] += cycle;
+            if (atelier.quantiles != Quantiles::aucun)
+            {
+                moi.esquisse.ajouter(cycle);
+                if (atelier.quantiles == Quantiles::par_file)
+                {
+                    atelier.esquisses[depart].ajouter(cycle);
+                }
+            }
+            atelier.files.retirer(depart);
+            bool reste_des_robots = !atelier.files.vide(depart);
+            if (!reste_des_robots)
+            {
+                atelier.non_vides.effacer_partage(depart);
+            }
+            politique.apres_chargement(depart, reste_des_robots);
+            moi.position = moi.robot;
+            ++moi.statistiques.robots;
+        }
+        else
+        {
+            if (moi.veut_charger)
+            {
+                ++moi.statistiques.conflits;
+            }
+            moi.robot = -1;
+            if (moi.repli != -1)
+            {
+                moi.position = moi.repli;
+            }
+        }
+        moi.statistiques.deplacements += atelier.param.distance(depart, moi.position);
+    }
+
+    // **Boucle d'un fil**
+    // Le fil premier fait tourner les scanners premier, premier + pas... : un par fil
+    // s'il y a assez de cœurs, sinon plusieurs par fil, avec le même résultat. Tous
+    // les fils voient le même état après chaque barrière : ils s'arrêtent au même
+    // cycle sans autre synchronisation.
+    template <class Politique>
+    static void faire_tourner(Atelier &atelier, int premier, int pas, const Parametres &param)
+    {
+        int nb_scanners = static_cast<int>(atelier.scanners.size());
+        vector<Politique> politiques((nb_scanners - premier + pas - 1) / pas);
+        for (Politique &politique : politiques)
+        {
+            politique.initialiser(param, atelier.non_vides);
+        }
+        long long cycle = 0;
+        while (!atelier.termine())
+        {
+            ++cycle;
+            for (int k = premier, i = 0; k < nb_scanners; k += pas, ++i)
+            {
+                decider(atelier, k, politiques[i], cycle);
+            }
+            atelier.barriere.attendre();
+            for (int k = premier, i = 0; k < nb_scanners; k += pas, ++i)
+            {
+                appliquer(atelier, k, politiques[i], cycle);
+            }
+            atelier.barriere.attendre();
+        }
+        if (premier == 0)
+        {
+            atelier.cycles = cycle;
+        }
+    }
+
+    bool politique_multi_scanners(TypePolitique politique)
+    {
+        return politique == TypePolitique::neqli || politique == TypePolitique::faneqli;
+    }
+
+    template <class Politique>
+    static void simuler_scanners(const Parametres &param, int nb_scanners, ResultatsScanners &resultats,
+                                 Quantiles quantiles)
+    {
+        unsigned coeurs = thread::hardware_concurrency();
+        int nb_fils = coeurs == 0 ? nb_scanners : min(nb_scanners, static_cast<int>(coeurs));
+        Atelier atelier(param, nb_scanners, nb_fils, quantiles);
+        for (int k = 0; k < nb_scanners; ++k)
+        {
+            atelier.scanners[k].position = static_cast<int>(static_cast<long long>(k) * param.nb_files / nb_scanners);
+        }
+        vector<thread> fils;
+        for (int k = 1; k < nb_fils; ++k)
+        {
+            fils.emplace_back([&, k] { faire_tourner<Politique>(atelier, k, nb_fils, param); });
+        }
+        faire_tourner<Politique>(atelier, 0, nb_fils, param);
+        for (thread &fil : fils)
+        {
+            fil.join();
+        }
+
+        long long deplacements = 0;
+        resultats.scanners.clear();
+        for (EtatScanner &scanner : atelier.scanners)
+        {
+            deplacements += scanner.statistiques.deplacements;
+            resultats.scanners.push_back(scanner.statistiques);
+            resultats.total.esquisse.fusionner(scanner.esquisse);
+        }
+        vector<int> nb_robots_initial(param.nb_files);
+        for (int i = 0; i < param.nb_files; ++i)
+        {
+            nb_robots_initial[i] = param.debuts[i + 1] - param.debuts[i];
+        }
+        stocker_resultats(atelier.cycles, deplacements, atelier.somme_indices_cycles, nb_robots_initial,
+                          param.nb_files, resultats.total);
+        resultats.total.esquisses = move(atelier.esquisses);
+    }
+
+    bool simuler_scanners(TypePolitique politique, const Parametres &param, int nb_scanners,
+                          ResultatsScanners &resultats, Quantiles quantiles)
+    {
+        nb_scanners = max(1, min(nb_scanners, MAX_SCANNERS));
+        resultats = ResultatsScanners();
+        switch (politique)
+        {
+        case TypePolitique::neqli:
+            simuler_scanners<PolitiqueNeqli>(param, nb_scanners, resultats, quantiles);
+            return true;
+        case TypePolitique::faneqli:
+            simuler_scanners<PolitiqueFaneqli>(param, nb_scanners, resultats, quantiles);
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    void afficher_statistiques_scanners(const vector<ResultatsScanners> &resultats, TamponSortie &sortie)
+    {
+        sortie.ecrire("Robots, déplacement et conflits par scanner\n");
+        size_t nb_scanners = resultats.empty() ? 0 : resultats[0].scanners.size();
+        for (size_t k = 0; k < nb_scanners; ++k)
+        {
+            sortie.ecrire_entier(k);
+            for (const ResultatsScanners &resultat : resultats)
+            {
+                const StatistiquesScanner &statistiques = resultat.scanners[k];
+                sortie.ecrire('\t');
+                sortie.ecrire_entier(statistiques.robots);
+                sortie.ecrire(' ');
+                sortie.ecrire_entier(statistiques.deplacements);
+                sortie.ecrire(' ');
+                sortie.ecrire_entier(statistiques.conflits);
+            }
+            sortie.ecrire('\n');
+        }
+    }
+
+} // teleporteur
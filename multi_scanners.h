@@ -0,0 +1,49 @@
+#ifndef MULTI_SCANNERS_H
+#define MULTI_SCANNERS_H
+
+#include "teleporteur.h"
+
+#include <vector>
+
+namespace teleporteur {
+
+class TamponSortie;
+
+// **Statistiques d'un scanner**
+struct StatistiquesScanner {
+    long long robots = 0;              // Robots chargés
+    long long deplacements = 0;
+    long long conflits = 0;            // Chargements perdus face à un scanner de plus petit numéro
+};
+
+// **Résultats d'une simulation à plusieurs scanners**
+struct ResultatsScanners {
+    Resultats total;                   // Cycles jusqu'à la fin, déplacements de tous les scanners
+    std::vector<StatistiquesScanner> scanners;
+};
+
+const int MAX_SCANNERS = 1024;
+
+// **Simulation à plusieurs scanners**
+// nb_scanners scanners servent les mêmes files, chacun sur son fil (plusieurs
+// par fil s'il y a moins de cœurs que de scanners) et avec sa propre politique
+// (NEQLI ou FANEQLI, tours comptés par scanner). Le scanner k
+// part de la file k * nb_files / nb_scanners. Les scanners avancent d'un cycle
+// ensemble, en deux phases séparées par une barrière : chacun décide d'abord
+// d'après l'état du début du cycle et réclame sa file par une opération atomique
+// sur un mot propre à la file, puis applique sa décision. Quand plusieurs
+// scanners réclament la même file, le plus petit numéro charge et les autres
+// repartent comme s'ils ne pouvaient pas charger : le résultat ne dépend pas de
+// l'ordre d'exécution des fils. Avec un seul scanner, mêmes statistiques que
+// neqli() et faneqli().
+// Faux si la politique n'est pas NEQLI ou FANEQLI.
+bool simuler_scanners(TypePolitique politique, const Parametres& param, int nb_scanners,
+                      ResultatsScanners& resultats, Quantiles quantiles = Quantiles::aucun);
+bool politique_multi_scanners(TypePolitique politique);
+
+// Robots, déplacements et conflits de chaque scanner, une colonne de trois par politique
+void afficher_statistiques_scanners(const std::vector<ResultatsScanners>& resultats, TamponSortie& sortie);
+
+} // teleporteur
+
+#endif
@@ -0,0 +1,134 @@
+#include "teleporteur.h"
+#include "instrumentation.h"
+#include "politiques.h"
+
+#include <array>
+#include <cstdint>
+
+using namespace std;
+
+namespace teleporteur
+{
+
+    // **Moteurs pour un petit nombre de files**
+    // Toutes les files tiennent dans un mot : non_vides et, pour FANEQLI, servies (files
+    // déjà servies dans le tour) sont des masques de 64 bits, et la file suivante se
+    // trouve en une instruction (ctz / clz) au lieu de descendre les niveaux
+    // d'IndexOccupation. Positions, fins de files et sommes des attentes sont dans des
+    // std::array de MAX_PETITES_FILES cases, sur la pile : aucune allocation pour
+    // l'état. Même boucle que MoteurCycles::avancer(), donc mêmes traces et mêmes
+    // résultats que le moteur générique. Une instanciation par politique.
+    template <TypePolitique P>
+    static Resultats simuler_petit(const Parametres &param, TamponSortie *trace, CompteursMoteur *compteurs,
+                                   Quantiles quantiles)
+    {
+        const int *destinations = param.destinations.data();
+        array<int, MAX_PETITES_FILES> positions{}, fins{};
+        array<long long, MAX_PETITES_FILES> somme_indices_cycles{};
+        uint64_t non_vides = 0, servies = 0;
+        for (int file = 0; file < param.nb_files; ++file)
+        {
+            positions[file] = param.debuts[file];
+            fins[file] = param.debuts[file + 1];
+            non_vides |= uint64_t(positions[file] < fins[file]) << file;
+        }
+        EsquissesMoteur esquisses(quantiles, param.nb_files);
+        long long cycles = 0, deplacements = 0;
+        int scanner = 0, robot_dans_scanner = -1;
+        bool montee = true; // SCAN
+
+        while (non_vides != 0 || robot_dans_scanner != -1)
+        {
+            if (P == TypePolitique::faneqli && (non_vides & ~servies) == 0)
+            {
+                servies = 0; // Toutes les files non vides ont été servies : nouveau tour
+            }
+            bool sortie = (robot_dans_scanner != -1);
+            int depart = scanner;
+            uint64_t bit = uint64_t(1) << depart;
+            ++cycles;
+            bool entree = (non_vides & ~servies & bit) != 0;
+            if (entree)
+            {
+                robot_dans_scanner = destinations[positions[depart]++];
+                non_vides &= ~(uint64_t(positions[depart] == fins[depart]) << depart);
+                if (P == TypePolitique::faneqli)
+                {
+                    servies |= bit;
+                }
+                scanner = robot_dans_scanner;
+                somme_indices_cycles[depart] += cycles;
+                esquisses.ajouter(depart, cycles);
+            }
+            else
+            {
+                robot_dans_scanner = -1;
+                uint64_t candidates = P == TypePolitique::faneqli ? non_vides & ~servies : non_vides;
+                if (candidates != 0)
+                {
+                    // Files marquées au-dessus (à partir de) et au-dessous (jusqu'à) du scanner
+                    uint64_t apres = candidates & (~uint64_t(0) << depart);
+                    uint64_t avant = candidates & ((uint64_t(2) << depart) - 1); // 2 << 63 donne 0 : tout le mot
+                    switch (P)
+                    {
+                    case TypePolitique::neqli:
+                    case TypePolitique::faneqli:
+                        scanner = __builtin_ctzll(candidates);
+                        break;
+                    case TypePolitique::sstf:
+                        if (avant == 0 || apres == 0)
+                        {
+                            scanner = avant == 0 ? __builtin_ctzll(apres) : 63 - __builtin_clzll(avant);
+                        }
+                        else
+                        {
+                            int bas = 63 - __builtin_clzll(avant), haut = __builtin_ctzll(apres);
+                            scanner = param.distance(bas, depart) <= param.distance(depart, haut) ? bas : haut;
+                        }
+                        break;
+                    case TypePolitique::scan:
+                        if ((montee ? apres : avant) == 0)
+                        {
+                            montee = !montee; // Bout de la course : demi-tour
+                        }
+                        scanner = montee ? __builtin_ctzll(apres) : 63 - __builtin_clzll(avant);
+                        break;
+                    }
+                }
+            }
+            long long distance = param.distance(depart, scanner);
+            deplacements += distance;
+            compter_cycle(compteurs, sortie, entree, distance);
+            afficher_cycle(trace, cycles, param.numero(depart), param.numero(scanner), sortie, entree);
+        }
+
+        vector<long long> sommes(somme_indices_cycles.begin(), somme_indices_cycles.begin() + param.nb_files);
+        vector<int> nb_robots_initial(param.nb_files);
+        for (int file = 0; file < param.nb_files; ++file)
+        {
+            nb_robots_initial[file] = param.debuts[file + 1] - param.debuts[file];
+        }
+        Resultats resultats;
+        stocker_resultats(cycles, deplacements, sommes, nb_robots_initial, param.nb_files, resultats);
+        esquisses.ranger(resultats);
+        return resultats;
+    }
+
+    Resultats simuler_petites_files(TypePolitique politique, const Parametres &param, TamponSortie *trace,
+                                    CompteursMoteur *compteurs, Quantiles quantiles)
+    {
+        switch (politique)
+        {
+        case TypePolitique::neqli:
+            return simuler_petit<TypePolitique::neqli>(param, trace, compteurs, quantiles);
+        case TypePolitique::faneqli:
+            return simuler_petit<TypePolitique::faneqli>(param, trace, compteurs, quantiles);
+        case TypePolitique::sstf:
+            return simuler_petit<TypePolitique::sstf>(param, trace, compteurs, quantiles);
+        case TypePolitique::scan:
+            return simuler_petit<TypePolitique::scan>(param, trace, compteurs, quantiles);
+        }
+        return Resultats();
+    }
+
+} // teleporteur
@@ -0,0 +1,254 @@
+#include "point_reprise.h"
+#include "texte_entree.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include <unistd.h>
+
+using namespace std;
+
+namespace teleporteur
+{
+
+    static const char MAGIE[8] = {'T', 'E', 'L', 'E', 'R', 'E', 'P', '1'};
+    static const string BAD_CHECKPOINT("Error: checkpoint does not match the scenario");
+    static const string BAD_CHECKPOINT_POLICY("Error: checkpoint was written for another policy");
+
+    struct EnteteReprise
+    {
+        char magie[8];
+        uint32_t politique;
+        int32_t scanner;
+        uint64_t empreinte;
+        int64_t cycles;
+        int64_t deplacements;
+        int64_t robot_dans_scanner;
+        uint64_t valeur_politique;
+        uint64_t nb_files;
+        uint64_t nb_tampons_politique;
+    };
+    static_assert(sizeof(EnteteReprise) % 8 == 0, "les tableaux suivent l'en-tête alignés sur 8 octets");
+
+    static size_t arrondi_8(size_t taille)
+    {
+        return (taille + 7) & ~size_t(7);
+    }
+
+    uint64_t empreinte_parametres(const Parametres &param)
+    {
+        // FNV-1a sur des entiers de 32 bits plutôt que sur des octets : quatre fois moins de tours
+        uint64_t h = 14695981039346656037ULL;
+        auto melanger = [&h](uint32_t valeur)
+        {
+            h ^= valeur;
+            h *= 1099511628211ULL;
+        };
+        melanger(static_cast<uint32_t>(param.nb_files));
+        for (int debut : param.debuts)
+        {
+            melanger(static_cast<uint32_t>(debut));
+        }
+        for (int destination : param.destinations)
+        {
+            melanger(static_cast<uint32_t>(destination));
+        }
+        for (long long numero : param.numeros) // Vide hors mode creux : empreintes inchangées
+        {
+            melanger(static_cast<uint32_t>(numero));
+            melanger(static_cast<uint32_t>(numero >> 32));
+        }
+        return h;
+    }
+
+    bool ecrire_point_reprise(const string &chemin, const EtatSimulation &etat)
+    {
+        EnteteReprise entete;
+        memset(&entete, 0, sizeof(entete));
+        memcpy(entete.magie, MAGIE, sizeof(MAGIE));
+        entete.politique = static_cast<uint32_t>(etat.politique);
+        entete.scanner = etat.scanner;
+        entete.empreinte = etat.empreinte;
+        entete.cycles = etat.cycles;
+        entete.deplacements = etat.deplacements;
+        entete.robot_dans_scanner = etat.robot_dans_scanner;
+        entete.valeur_politique = etat.valeur_politique;
+        entete.nb_files = etat.positions.size();
+        entete.nb_tampons_politique = etat.tampons_politique.size();
+
+        string temporaire = chemin + ".tmp";
+        FILE *fichier = fopen(temporaire.c_str(), "wb");
+        if (fichier == nullptr)
+        {
+            return false;
+        }
+        static const char zeros[8] = {};
+        size_t octets_positions = etat.positions.size() * sizeof(int);
+        size_t octets_tampons = etat.tampons_politique.size() * sizeof(uint32_t);
+        bool ok = fwrite(&entete, sizeof(entete), 1, fichier) == 1 &&
+                  fwrite(etat.positions.data(), 1, octets_positions, fichier) == octets_positions &&
+                  fwrite(zeros, 1, arrondi_8(octets_positions) - octets_positions, fichier) ==
+                      arrondi_8(octets_positions) - octets_positions &&
+                  fwrite(etat.somme_indices_cycles.data(), sizeof(long long), etat.somme_indices_cycles.size(),
+                         fichier) == etat.somme_indices_cycles.size() &&
+                  fwrite(etat.tampons_politique.data(), 1, octets_tampons, fichier) == octets_tampons &&
+                  fflush(fichier) == 0 && fsync(fileno(fichier)) == 0;
+        ok = (fclose(fichier) == 0) && ok;
+        if (!ok || rename(temporaire.c_str(), chemin.c_str()) != 0)
+        {
+            remove(temporaire.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    bool lire_point_reprise(const string &chemin, EtatSimulation &etat)
+    {
+        TexteEntree fichier; // Projection mémoire du fichier
+        if (!fichier.charger_fichier(chemin))
+        {
+            return false;
+        }
+        const char *octets = fichier.debut();
+        size_t taille = fichier.fin() - fichier.debut();
+        EnteteReprise entete;
+        if (taille < sizeof(entete))
+        {
+            return false;
+        }
+        memcpy(&entete, octets, sizeof(entete));
+        if (memcmp(entete.magie, MAGIE, sizeof(MAGIE)) != 0 || entete.politique > 3 ||
+            entete.nb_files > (uint64_t(1) << 31) || entete.nb_tampons_politique > (uint64_t(1) << 31))
+        {
+            return false;
+        }
+        size_t octets_positions = arrondi_8(entete.nb_files * sizeof(int));
+        size_t octets_sommes = entete.nb_files * sizeof(long long);
+        if (taille != sizeof(entete) + octets_positions + octets_sommes +
+                          entete.nb_tampons_politique * sizeof(uint32_t))
+        {
+            return false;
+        }
+
+        etat.politique = static_cast<TypePolitique>(entete.politique);
+        etat.empreinte = entete.empreinte;
+        etat.cycles = entete.cycles;
+        etat.deplacements = entete.deplacements;
+        etat.scanner = entete.scanner;
+        etat.robot_dans_scanner = static_cast<int>(entete.robot_dans_scanner);
+        etat.valeur_politique = entete.valeur_politique;
+        const char *p = octets + sizeof(entete);
+        etat.positions.resize(entete.nb_files);
+        memcpy(etat.positions.data(), p, entete.nb_files * sizeof(int));
+        p += octets_positions;
+        etat.somme_indices_cycles.resize(entete.nb_files);
+        memcpy(etat.somme_indices_cycles.data(), p, octets_sommes);
+        p += octets_sommes;
+        etat.tampons_politique.resize(entete.nb_tampons_politique);
+        memcpy(etat.tampons_politique.data(), p, entete.nb_tampons_politique * sizeof(uint32_t));
+        return true;
+    }
+
+    string verifier_point_reprise(const EtatSimulation &etat, const Parametres &param,
+                                  TypePolitique politique, uint64_t empreinte)
+    {
+        if (etat.politique != politique)
+        {
+            return BAD_CHECKPOINT_POLICY;
+        }
+        size_t nb_files = param.nb_files;
+        bool tampons_valides = politique == TypePolitique::faneqli ? etat.tampons_politique.size() == nb_files
+                                                                   : etat.tampons_politique.empty();
+        if (etat.empreinte != empreinte || etat.positions.size() != nb_files ||
+            etat.somme_indices_cycles.size() != nb_files || !tampons_valides || etat.cycles < 0 ||
+            etat.scanner < 0 || etat.scanner >= param.nb_files ||
+            etat.robot_dans_scanner < -1 || etat.robot_dans_scanner >= param.nb_files)
+        {
+            return BAD_CHECKPOINT;
+        }
+        for (size_t i = 0; i < nb_files; ++i)
+        {
+            if (etat.positions[i] < param.debuts[i] || etat.positions[i] > param.debuts[i + 1])
+            {
+                return BAD_CHECKPOINT;
+            }
+        }
+        return "";
+    }
+
+    EcrivainPointsReprise::EcrivainPointsReprise(const string &chemin, long long intervalle)
+        : chemin(chemin), pas(intervalle > 0 ? intervalle : 1)
+    {
+        fil = thread(&EcrivainPointsReprise::boucle, this);
+    }
+
+    EcrivainPointsReprise::~EcrivainPointsReprise()
+    {
+        {
+            lock_guard<mutex> garde(verrou);
+            arret = true;
+        }
+        reveil.notify_all();
+        fil.join();
+    }
+
+    EtatSimulation &EcrivainPointsReprise::tampon_libre()
+    {
+        lock_guard<mutex> garde(verrou);
+        // Le tampon en attente, s'il y en a un, est remplacé par l'état plus récent
+        en_remplissage = (pret != -1) ? pret : (en_ecriture == 0 ? 1 : 0);
+        pret = -1;
+        return tampons[en_remplissage];
+    }
+
+    void EcrivainPointsReprise::publier()
+    {
+        {
+            lock_guard<mutex> garde(verrou);
+            pret = en_remplissage;
+            en_remplissage = -1;
+            ++publies;
+        }
+        reveil.notify_all();
+    }
+
+    void EcrivainPointsReprise::attendre()
+    {
+        unique_lock<mutex> garde(verrou);
+        reveil.wait(garde, [this] { return pret == -1 && en_ecriture == -1; });
+    }
+
+    bool EcrivainPointsReprise::erreur() const
+    {
+        lock_guard<mutex> garde(verrou);
+        return echec;
+    }
+
+    long long EcrivainPointsReprise::nb_publies() const
+    {
+        lock_guard<mutex> garde(verrou);
+        return publies;
+    }
+
+    void EcrivainPointsReprise::boucle()
+    {
+        unique_lock<mutex> garde(verrou);
+        while (true)
+        {
+            reveil.wait(garde, [this] { return pret != -1 || arret; });
+            if (pret == -1)
+            {
+                return; // Arrêt demandé et plus rien à écrire
+            }
+            en_ecriture = pret;
+            pret = -1;
+            garde.unlock();
+            bool ok = ecrire_point_reprise(chemin, tampons[en_ecriture]);
+            garde.lock();
+            echec = echec || !ok;
+            en_ecriture = -1;
+            reveil.notify_all();
+        }
+    }
+
+} // teleporteur
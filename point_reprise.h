@@ -0,0 +1,90 @@
+#ifndef POINT_REPRISE_H
+#define POINT_REPRISE_H
+
+#include "teleporteur.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace teleporteur {
+
+// **État d'une simulation entre deux cycles**
+// Tout ce qu'il faut à simuler<Politique>() et à neqli_rapide() pour continuer :
+// les files non vides se déduisent des curseurs, et les ensembles de FANEQLI de
+// tour_servi (tampons_politique) et du tour courant (valeur_politique).
+struct EtatSimulation {
+    TypePolitique politique = TypePolitique::neqli;
+    std::uint64_t empreinte = 0;                   // empreinte_parametres() du scénario simulé
+    long long cycles = 0;
+    long long deplacements = 0;
+    int scanner = 0;
+    int robot_dans_scanner = -1;
+    std::vector<int> positions;                    // CurseursFiles::positions
+    std::vector<long long> somme_indices_cycles;
+    std::vector<std::uint32_t> tampons_politique;  // État par file propre à la politique
+    std::uint64_t valeur_politique = 0;            // État global propre à la politique
+};
+
+// Empreinte FNV-1a des files : un point de reprise ne s'applique qu'à son scénario
+std::uint64_t empreinte_parametres(const Parametres& param);
+
+// **Fichier de point de reprise**
+// Un en-tête de taille fixe puis positions (int32), somme_indices_cycles (int64) et
+// tampons_politique (uint32), chacun aligné sur 8 octets : les tableaux se lisent
+// directement dans la projection mémoire du fichier. L'écriture passe par un fichier
+// temporaire renommé à la fin, un point de reprise n'est donc jamais à moitié écrit.
+bool ecrire_point_reprise(const std::string& chemin, const EtatSimulation& etat);
+bool lire_point_reprise(const std::string& chemin, EtatSimulation& etat); // Faux si absent ou invalide
+
+// **Écriture des points de reprise en arrière-plan**
+// Deux tampons : le moteur recopie son état dans celui que le fil d'écriture n'est
+// pas en train d'écrire, puis reprend aussitôt. Un état pas encore écrit est
+// remplacé par le suivant ; la simulation n'attend jamais le disque, sauf pour
+// l'état final (attendre()).
+class EcrivainPointsReprise
+{
+public:
+    EcrivainPointsReprise(const std::string& chemin, long long intervalle);
+    ~EcrivainPointsReprise();                      // Attend la fin de l'écriture en cours
+    EcrivainPointsReprise(const EcrivainPointsReprise&) = delete;
+    EcrivainPointsReprise& operator=(const EcrivainPointsReprise&) = delete;
+
+    long long intervalle() const { return pas; }   // En cycles
+    EtatSimulation& tampon_libre();                // À remplir puis publier()
+    void publier();
+    void attendre();                               // Jusqu'à ce que le dernier état publié soit écrit
+    bool erreur() const;                           // Vrai si une écriture a échoué
+    long long nb_publies() const;                  // États publiés, écrits ou remplacés
+
+private:
+    void boucle();
+
+    std::string chemin;
+    long long pas;
+    EtatSimulation tampons[2];
+    int en_remplissage = -1, pret = -1, en_ecriture = -1;
+    bool arret = false, echec = false;
+    long long publies = 0;
+    mutable std::mutex verrou;
+    std::condition_variable reveil;
+    std::thread fil;
+};
+
+// **Reprise d'une simulation**
+struct Reprise {
+    const EtatSimulation* depart = nullptr;        // État à reprendre, sinon départ au cycle 0
+    EcrivainPointsReprise* ecrivain = nullptr;     // Points de reprise périodiques, sinon aucun
+    std::uint64_t empreinte = 0;                   // empreinte_parametres(), recopiée dans les états écrits
+};
+
+// Message d'erreur si etat ne peut pas reprendre la politique sur ces paramètres, vide sinon
+std::string verifier_point_reprise(const EtatSimulation& etat, const Parametres& param,
+                                   TypePolitique politique, std::uint64_t empreinte);
+
+} // teleporteur
+
+#endif
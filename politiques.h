@@ -0,0 +1,361 @@
+#ifndef POLITIQUES_H
+#define POLITIQUES_H
+
+#include "teleporteur.h"
+#include "point_reprise.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Politiques d'ordonnancement partagées par les moteurs ; en-tête interne,
+// inclus seulement par les fichiers .cpp des moteurs.
+
+namespace teleporteur {
+
+// Une politique choisit vers quelle file partir quand le scanner ne charge pas,
+// et peut interdire de charger depuis une file. Les moteurs simuler<Politique>()
+// et simuler_flux<Politique>() sont instanciés pour chacune : tout est inliné,
+// sans appel virtuel. apres_chargement() dit si la file chargée garde des
+// robots ; apres_arrivee() signale une file vide qui reçoit un robot en cours de
+// simulation (mode flux) ; sauver() et restaurer() passent l'état de la politique
+// par un point de reprise. NEQLI et FANEQLI servent aussi simuler_scanners() :
+// oublier_files_videes() y retire les files vidées par un autre scanner. Une file
+// réclamée par un autre scanner n'est pas à oublier : le chargement perdu est vu
+// comme un chargement refusé.
+
+// NEQLI et SSTF n'ont pas d'état à sauver
+struct PolitiqueSansEtat
+{
+    void sauver(EtatSimulation& etat) const
+    {
+        etat.tampons_politique.clear();
+        etat.valeur_politique = 0;
+    }
+    void restaurer(const EtatSimulation&, const IndexOccupation&) {}
+};
+
+// **NEQLI : toujours la première file non vide**
+struct PolitiqueNeqli : PolitiqueSansEtat
+{
+    static const TypePolitique type = TypePolitique::neqli;
+
+    void initialiser(const Parametres&, const IndexOccupation&) {}
+    void debut_cycle(const IndexOccupation&) {}
+    bool peut_charger(int) const { return true; }
+    void apres_chargement(int, bool) {}
+    void apres_arrivee(int) {}
+    int prochaine_file(int, const IndexOccupation& non_vides) { return trouver_prochaine_file(non_vides); }
+    void oublier_files_videes(const IndexOccupation&) {}      // Choisit déjà d'après non_vides
+};
+
+// **FANEQLI : chaque file non vide est servie une fois par tour**
+// Une file est servie dans le tour courant si son tampon tour_servi vaut tour.
+// eligibles contient les files non vides pas encore servies ; une file servie qui
+// garde des robots passe dans prochain_tour. Quand eligibles est vide, le tour
+// suivant commence en O(1) : ++tour et échange des deux index.
+struct PolitiqueFaneqli
+{
+    static const TypePolitique type = TypePolitique::faneqli;
+
+    std::vector<std::uint32_t> tour_servi;
+    std::uint32_t tour = 1;
+    IndexOccupation eligibles, prochain_tour;
+
+    void initialiser(const Parametres& param, const IndexOccupation& non_vides)
+    {
+        tour_servi.assign(param.nb_files, 0);
+        tour = 1;
+        eligibles = non_vides;
+        prochain_tour.initialiser(param.nb_files);
+    }
+    void debut_cycle(const IndexOccupation&)
+    {
+        if (eligibles.vide() && !prochain_tour.vide())
+        {
+            if (++tour == 0) // Après 2^32 tours, les anciens tampons pourraient être confondus
+            {
+                std::fill(tour_servi.begin(), tour_servi.end(), 0);
+                tour = 1;
+            }
+            std::swap(eligibles, prochain_tour);
+        }
+    }
+    bool peut_charger(int file) const { return tour_servi[file] != tour; }
+    void apres_chargement(int file, bool reste_des_robots)
+    {
+        tour_servi[file] = tour;
+        eligibles.effacer(file);
+        if (reste_des_robots)
+        {
+            prochain_tour.marquer(file);
+        }
+    }
+    void apres_arrivee(int file)
+    {
+        // Déjà servie dans ce tour : elle attend le suivant
+        if (tour_servi[file] == tour)
+        {
+            prochain_tour.marquer(file);
+        }
+        else
+        {
+            eligibles.marquer(file);
+        }
+    }
+    int prochaine_file(int, const IndexOccupation&) { return eligibles.premiere(); }
+    // Plusieurs scanners : une file vidée par un autre reste dans les index de
+    // celui-ci. Elle en sort quand elle arrive en tête, ce qui suffit à
+    // debut_cycle() et à prochaine_file().
+    void oublier_files_videes(const IndexOccupation& non_vides)
+    {
+        oublier_en_tete(eligibles, non_vides);
+        oublier_en_tete(prochain_tour, non_vides);
+    }
+    static void oublier_en_tete(IndexOccupation& index, const IndexOccupation& non_vides)
+    {
+        for (int file = index.premiere(); file != -1 && !non_vides.contient(file); file = index.suivante(file + 1))
+        {
+            index.effacer(file);
+        }
+    }
+    void sauver(EtatSimulation& etat) const
+    {
+        etat.tampons_politique.assign(tour_servi.begin(), tour_servi.end());
+        etat.valeur_politique = tour;
+    }
+    // Une file non vide attend le tour suivant si elle a déjà été servie dans celui-ci
+    void restaurer(const EtatSimulation& etat, const IndexOccupation& non_vides)
+    {
+        tour_servi.assign(etat.tampons_politique.begin(), etat.tampons_politique.end());
+        tour = static_cast<std::uint32_t>(etat.valeur_politique);
+        eligibles.initialiser(static_cast<int>(tour_servi.size()));
+        prochain_tour.initialiser(static_cast<int>(tour_servi.size()));
+        for (int file = non_vides.premiere(); file != -1; file = non_vides.suivante(file + 1))
+        {
+            if (tour_servi[file] == tour)
+            {
+                prochain_tour.marquer(file);
+            }
+            else
+            {
+                eligibles.marquer(file);
+            }
+        }
+    }
+};
+
+// **SSTF : la file non vide la plus proche du scanner (la plus basse en cas d'égalité)**
+// Proche au sens des numéros de file : en mode creux, les indices ne suffisent pas.
+struct PolitiqueSstf : PolitiqueSansEtat
+{
+    static const TypePolitique type = TypePolitique::sstf;
+
+    const Parametres* param = nullptr;
+
+    void initialiser(const Parametres& p, const IndexOccupation&) { param = &p; }
+    void debut_cycle(const IndexOccupation&) {}
+    bool peut_charger(int) const { return true; }
+    void apres_chargement(int, bool) {}
+    void apres_arrivee(int) {}
+    int prochaine_file(int scanner, const IndexOccupation& non_vides)
+    {
+        int avant = non_vides.precedente(scanner);
+        int apres = non_vides.suivante(scanner);
+        if (avant == -1 || apres == -1)
+        {
+            return avant == -1 ? apres : avant;
+        }
+        return param->distance(avant, scanner) <= param->distance(scanner, apres) ? avant : apres;
+    }
+};
+
+// **SCAN (ascenseur) : on continue dans le même sens tant qu'il reste des files non vides**
+struct PolitiqueScan
+{
+    static const TypePolitique type = TypePolitique::scan;
+
+    bool montee = true;
+
+    void initialiser(const Parametres&, const IndexOccupation&) { montee = true; }
+    void debut_cycle(const IndexOccupation&) {}
+    bool peut_charger(int) const { return true; }
+    void apres_chargement(int, bool) {}
+    void apres_arrivee(int) {}
+    int prochaine_file(int scanner, const IndexOccupation& non_vides)
+    {
+        int prochaine = montee ? non_vides.suivante(scanner) : non_vides.precedente(scanner);
+        if (prochaine == -1)
+        {
+            montee = !montee; // Bout de la course : demi-tour
+            prochaine = montee ? non_vides.suivante(scanner) : non_vides.precedente(scanner);
+        }
+        return prochaine;
+    }
+    void sauver(EtatSimulation& etat) const
+    {
+        etat.tampons_politique.clear();
+        etat.valeur_politique = montee;
+    }
+    void restaurer(const EtatSimulation& etat, const IndexOccupation&) { montee = etat.valeur_politique != 0; }
+};
+
+// **Esquisses des attentes remplies par un moteur**
+struct EsquissesMoteur
+{
+    Quantiles quantiles;
+    EsquisseAttente globale;
+    std::vector<EsquisseAttente> par_file;
+
+    EsquissesMoteur(Quantiles quantiles, int nb_files)
+        : quantiles(quantiles), par_file(quantiles == Quantiles::par_file ? nb_files : 0) {}
+    void ajouter(int file, long long attente)
+    {
+        if (quantiles == Quantiles::aucun)
+        {
+            return;
+        }
+        globale.ajouter(attente);
+        if (quantiles == Quantiles::par_file)
+        {
+            par_file[file].ajouter(attente);
+        }
+    }
+    void ranger(Resultats& resultats)
+    {
+        resultats.esquisse = std::move(globale);
+        resultats.esquisses = std::move(par_file);
+    }
+};
+
+// **Points de reprise des moteurs**
+// Recopie l'état du moteur dans le tampon libre de l'écrivain et le lui confie.
+template <class Politique>
+void publier_etat(Reprise& reprise, long long cycles, long long deplacements, int scanner,
+                  int robot_dans_scanner, const CurseursFiles& files,
+                  const std::vector<long long>& somme_indices_cycles, const Politique& politique)
+{
+    EtatSimulation& etat = reprise.ecrivain->tampon_libre();
+    etat.politique = Politique::type;
+    etat.empreinte = reprise.empreinte;
+    etat.cycles = cycles;
+    etat.deplacements = deplacements;
+    etat.scanner = scanner;
+    etat.robot_dans_scanner = robot_dans_scanner;
+    etat.positions = files.positions;
+    etat.somme_indices_cycles = somme_indices_cycles;
+    politique.sauver(etat);
+    reprise.ecrivain->publier();
+}
+
+// Remet le moteur dans l'état sauvé ; files, non_vides et politique sont déjà initialisés
+template <class Politique>
+void restaurer_etat(const EtatSimulation& etat, long long& cycles, long long& deplacements, int& scanner,
+                    int& robot_dans_scanner, CurseursFiles& files, std::vector<long long>& somme_indices_cycles,
+                    IndexOccupation& non_vides, Politique& politique)
+{
+    cycles = etat.cycles;
+    deplacements = etat.deplacements;
+    scanner = etat.scanner;
+    robot_dans_scanner = etat.robot_dans_scanner;
+    files.positions = etat.positions;
+    somme_indices_cycles = etat.somme_indices_cycles;
+    for (int file = non_vides.premiere(); file != -1; file = non_vides.suivante(file + 1))
+    {
+        if (files.vide(file))
+        {
+            non_vides.effacer(file);
+        }
+    }
+    politique.restaurer(etat, non_vides);
+}
+
+// **Moteur cycle par cycle**
+// L'état de simuler<Politique>() et un cycle à la fois : simuler() y ajoute la
+// trace, les compteurs et les points de reprise, IterateurCycles le fait avancer
+// à la demande.
+struct PasMoteur
+{
+    int depart;                        // Indice de la file de départ ; l'arrivée est scanner
+    long long distance;
+    bool sortie;
+    bool entree;
+};
+
+template <class Politique>
+struct MoteurCycles
+{
+    const Parametres& param;
+    Politique politique;
+    long long cycles, deplacements;
+    int scanner, robot_dans_scanner;
+    std::vector<long long> somme_indices_cycles;
+    std::vector<int> nb_robots_initial;
+    CurseursFiles files;
+    IndexOccupation non_vides;
+    EsquissesMoteur esquisses;
+
+    MoteurCycles(const Parametres& param, Quantiles quantiles)
+        : param(param), esquisses(quantiles, param.nb_files)
+    {
+        initialiser_variables(param, cycles, deplacements, scanner, robot_dans_scanner,
+                              somme_indices_cycles, nb_robots_initial);
+        files.initialiser(param);
+        mettre_a_jour_files_non_vides(param, non_vides);
+        politique.initialiser(param, non_vides);
+    }
+
+    bool termine() const { return toutes_files_vides(non_vides) && robot_dans_scanner == -1; }
+
+    // Si la file du scanner a un robot que la politique permet de prendre, il est
+    // chargé (le robot précédent étant déchargé dans le même cycle) et emmené à sa
+    // sortie. Sinon le scanner se décharge et part vers la file choisie par la
+    // politique, ou reste sur place s'il n'y en a plus.
+    PasMoteur avancer()
+    {
+        politique.debut_cycle(non_vides);
+        PasMoteur pas;
+        pas.sortie = (robot_dans_scanner != -1);
+        pas.depart = scanner;
+        ++cycles;
+        pas.entree = !files.vide(pas.depart) && politique.peut_charger(pas.depart);
+        if (pas.entree)
+        {
+            robot_dans_scanner = files.tete(pas.depart);
+            files.retirer(pas.depart);
+            if (files.vide(pas.depart))
+            {
+                non_vides.effacer(pas.depart);
+            }
+            politique.apres_chargement(pas.depart, !files.vide(pas.depart));
+            scanner = robot_dans_scanner;
+            somme_indices_cycles[pas.depart] += cycles;
+            esquisses.ajouter(pas.depart, cycles);
+        }
+        else
+        {
+            robot_dans_scanner = -1;
+            int prochaine_file = politique.prochaine_file(pas.depart, non_vides);
+            if (prochaine_file != -1)
+            {
+                scanner = prochaine_file;
+            }
+        }
+        pas.distance = param.distance(pas.depart, scanner);
+        deplacements += pas.distance;
+        return pas;
+    }
+
+    Resultats resultats()
+    {
+        Resultats resultats;
+        stocker_resultats(cycles, deplacements, somme_indices_cycles, nb_robots_initial, param.nb_files, resultats);
+        esquisses.ranger(resultats);
+        return resultats;
+    }
+};
+
+} // teleporteur
+
+#endif
@@ -0,0 +1,52 @@
+#include "trace_binaire.h"
+#include "tampon_sortie.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace teleporteur;
+
+// **Relecture d'une trace binaire**
+// Réécrit en texte SHOW_CYCLES les cycles demandés d'une trace écrite avec
+// --trace-binaire, sans lire le reste du fichier. --resume donne le nombre de
+// cycles et les numéros du premier et du dernier.
+
+static int usage(const char* programme) {
+	std::fprintf(stderr, "Usage : %s TRACE [PREMIER_CYCLE [DERNIER_CYCLE]]\n"
+	                     "        %s --resume TRACE\n", programme, programme);
+	return 1;
+}
+
+int main(int argc, char* argv[]) {
+	bool resume = argc > 1 && std::strcmp(argv[1], "--resume") == 0;
+	int premier_argument = resume ? 2 : 1;
+	if (argc <= premier_argument || argc > (resume ? 3 : 4)) {
+		return usage(argv[0]);
+	}
+	LecteurTraceBinaire trace;
+	if (!trace.ouvrir(argv[premier_argument])) {
+		std::fprintf(stderr, "Trace binaire illisible : %s\n", argv[premier_argument]);
+		return 1;
+	}
+	TamponSortie& sortie = sortie_standard();
+	if (resume) {
+		sortie.ecrire_entier(trace.nb_cycles());
+		sortie.ecrire('\t');
+		sortie.ecrire_entier(trace.premier_cycle());
+		sortie.ecrire('\t');
+		sortie.ecrire_entier(trace.dernier_cycle());
+		sortie.ecrire('\n');
+		sortie.vider();
+		return 0;
+	}
+	long long premier = argc > 2 ? std::atoll(argv[2]) : trace.premier_cycle();
+	long long dernier = argc > 3 ? std::atoll(argv[3]) : trace.dernier_cycle();
+	bool ok = trace.rejouer(premier, dernier, sortie);
+	sortie.vider();
+	if (!ok) {
+		std::fprintf(stderr, "Trace binaire corrompue : %s\n", argv[premier_argument]);
+		return 1;
+	}
+	return 0;
+}
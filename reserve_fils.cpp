@@ -0,0 +1,122 @@
+#include "reserve_fils.h"
+
+using namespace std;
+
+namespace teleporteur
+{
+
+    ReserveFils::ReserveFils(unsigned nb_fils)
+    {
+        if (nb_fils == 0)
+        {
+            nb_fils = max(1u, thread::hardware_concurrency());
+        }
+        for (unsigned i = 0; i < nb_fils; ++i)
+        {
+            files.push_back(make_unique<FileTaches>());
+        }
+        for (unsigned i = 0; i < nb_fils; ++i)
+        {
+            fils.emplace_back(&ReserveFils::travailler, this, i);
+        }
+    }
+
+    ReserveFils::~ReserveFils()
+    {
+        {
+            lock_guard<mutex> garde(verrou);
+            arret = true;
+        }
+        reveil.notify_all();
+        for (thread &fil : fils)
+        {
+            fil.join();
+        }
+    }
+
+    void ReserveFils::soumettre(function<void()> tache)
+    {
+        // Répartition circulaire ; le vol rééquilibre ensuite
+        unsigned cible;
+        {
+            lock_guard<mutex> garde(verrou);
+            cible = prochaine_file;
+            prochaine_file = (prochaine_file + 1) % files.size();
+            ++nb_restantes;
+        }
+        {
+            lock_guard<mutex> garde(files[cible]->verrou);
+            files[cible]->taches.push_back(move(tache));
+        }
+        {
+            lock_guard<mutex> garde(verrou);
+            ++nb_disponibles;
+        }
+        reveil.notify_one();
+    }
+
+    void ReserveFils::attendre()
+    {
+        unique_lock<mutex> garde(verrou);
+        fin.wait(garde, [this] { return nb_restantes == 0; });
+    }
+
+    bool ReserveFils::prendre(unsigned moi, function<void()> &tache)
+    {
+        // D'abord la plus ancienne de sa propre file : les tâches finissent à peu près
+        // dans l'ordre où elles ont été soumises
+        {
+            FileTaches &propre = *files[moi];
+            lock_guard<mutex> garde(propre.verrou);
+            if (!propre.taches.empty())
+            {
+                tache = move(propre.taches.front());
+                propre.taches.pop_front();
+                return true;
+            }
+        }
+        // Sinon, vol de la plus récente chez un voisin, loin de celle qu'il va prendre
+        for (size_t k = 1; k < files.size(); ++k)
+        {
+            FileTaches &voisine = *files[(moi + k) % files.size()];
+            lock_guard<mutex> garde(voisine.verrou);
+            if (!voisine.taches.empty())
+            {
+                tache = move(voisine.taches.back());
+                voisine.taches.pop_back();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void ReserveFils::travailler(unsigned moi)
+    {
+        while (true)
+        {
+            {
+                unique_lock<mutex> garde(verrou);
+                reveil.wait(garde, [this] { return arret || nb_disponibles > 0; });
+                if (nb_disponibles == 0)
+                {
+                    return; // arret demandé et plus rien à faire
+                }
+                --nb_disponibles; // Une tâche nous est réservée quelque part
+            }
+
+            function<void()> tache;
+            while (!prendre(moi, tache))
+            {
+                this_thread::yield(); // Poussée en cours par soumettre()
+            }
+            tache();
+
+            lock_guard<mutex> garde(verrou);
+            if (--nb_restantes == 0)
+            {
+                fin.notify_all();
+            }
+        }
+    }
+
+} // teleporteur
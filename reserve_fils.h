@@ -0,0 +1,54 @@
+#ifndef RESERVE_FILS_H
+#define RESERVE_FILS_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace teleporteur {
+
+// **Réserve de fils d'exécution avec vol de tâches**
+// Chaque fil a sa propre file de tâches : il prend la plus ancienne chez lui et,
+// quand il n'a plus rien, vole la plus récente chez un voisin. Les tâches de
+// tailles très différentes se répartissent ainsi sur tous les cœurs, et des
+// tâches soumises d'avance finissent à peu près dans l'ordre de soumission.
+// Une tâche ne doit pas lever d'exception : elle arrêterait le programme.
+class ReserveFils
+{
+public:
+    explicit ReserveFils(unsigned nb_fils = 0); // 0 : un fil par cœur
+    ~ReserveFils();
+    ReserveFils(const ReserveFils&) = delete;
+    ReserveFils& operator=(const ReserveFils&) = delete;
+
+    void soumettre(std::function<void()> tache);
+    void attendre(); // Jusqu'à ce que toutes les tâches soumises soient terminées
+    unsigned taille() const { return static_cast<unsigned>(fils.size()); }
+
+private:
+    struct FileTaches
+    {
+        std::mutex verrou;
+        std::deque<std::function<void()>> taches;
+    };
+
+    void travailler(unsigned moi);
+    bool prendre(unsigned moi, std::function<void()>& tache);
+
+    std::vector<std::unique_ptr<FileTaches>> files;
+    std::vector<std::thread> fils;
+    std::mutex verrou;
+    std::condition_variable reveil, fin;
+    std::size_t nb_disponibles = 0; // Tâches soumises pas encore prises
+    std::size_t nb_restantes = 0;   // Tâches soumises pas encore terminées
+    unsigned prochaine_file = 0;
+    bool arret = false;
+};
+
+} // teleporteur
+
+#endif
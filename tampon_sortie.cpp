@@ -0,0 +1,85 @@
+#include "tampon_sortie.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+using namespace std;
+
+namespace teleporteur
+{
+
+    TamponSortie::TamponSortie(FILE *flux, size_t capacite)
+        : flux(flux), tampon(capacite < 64 ? 64 : capacite)
+    {
+    }
+
+    TamponSortie::~TamponSortie()
+    {
+        vider();
+    }
+
+    void TamponSortie::faire_place(size_t longueur)
+    {
+        if (flux == nullptr)
+        {
+            tampon.resize(max(tampon.size() * 2, taille + longueur));
+        }
+        else
+        {
+            vider();
+        }
+    }
+
+    void TamponSortie::ecrire(const char *texte, size_t longueur)
+    {
+        if (taille + longueur > tampon.size())
+        {
+            faire_place(longueur);
+            if (longueur > tampon.size())
+            {
+                // Trop long pour le tampon : écriture directe
+                fwrite(texte, 1, longueur, flux);
+                return;
+            }
+        }
+        memcpy(tampon.data() + taille, texte, longueur);
+        taille += longueur;
+    }
+
+    void TamponSortie::ecrire_entier(long long valeur)
+    {
+        // 20 caractères suffisent pour tout long long avec son signe
+        if (taille + 20 > tampon.size())
+            faire_place(20);
+        taille = to_chars(tampon.data() + taille, tampon.data() + tampon.size(), valeur).ptr - tampon.data();
+    }
+
+    void TamponSortie::ecrire_decimal(double valeur, int precision)
+    {
+        char texte[350]; // Assez pour le plus grand double en notation fixe
+        auto resultat = to_chars(texte, texte + sizeof(texte), valeur, chars_format::fixed, precision);
+        ecrire(texte, resultat.ptr - texte);
+    }
+
+    void TamponSortie::vider()
+    {
+        if (flux == nullptr)
+        {
+            return; // Tampon en mémoire : rien à écrire
+        }
+        if (taille > 0)
+        {
+            fwrite(tampon.data(), 1, taille, flux);
+            taille = 0;
+        }
+        fflush(flux);
+    }
+
+    TamponSortie &sortie_standard()
+    {
+        static TamponSortie sortie(stdout, 1 << 20);
+        return sortie;
+    }
+
+} // teleporteur
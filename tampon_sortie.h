@@ -0,0 +1,63 @@
+#ifndef TAMPON_SORTIE_H
+#define TAMPON_SORTIE_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace teleporteur {
+
+// Reçoit un cycle de trace à la place de sa ligne de texte (voir detourner_cycles())
+using RappelCycle = void (*)(void* contexte, long long cycle, long long depart, long long arrivee,
+                             bool sortie, bool entree);
+
+// **Tampon de sortie**
+// Accumule le texte dans un grand tampon réutilisé et ne l'écrit dans le flux
+// que lorsqu'il est plein ou sur demande (vider). Remplace cout/endl, qui
+// vidait le flux à chaque ligne. Les nombres sont formatés avec std::to_chars
+// et donnent exactement le même texte que cout (y compris fixed/setprecision).
+// Sans flux (nullptr), le tampon grandit au lieu d'être vidé et garde tout le
+// texte en mémoire, récupérable avec texte().
+// Un tampon passé comme trace aux moteurs peut détourner les cycles vers un
+// rappel : afficher_cycle() les lui donne au lieu de les formater.
+class TamponSortie
+{
+public:
+    explicit TamponSortie(std::FILE* flux = stdout, std::size_t capacite = 1 << 16);
+    ~TamponSortie();
+    TamponSortie(const TamponSortie&) = delete;
+    TamponSortie& operator=(const TamponSortie&) = delete;
+
+    void ecrire(char c)
+    {
+        if (taille == tampon.size())
+            faire_place(1);
+        tampon[taille++] = c;
+    }
+    void ecrire(const char* texte, std::size_t longueur);
+    void ecrire(const std::string& texte) { ecrire(texte.data(), texte.size()); }
+    void ecrire_entier(long long valeur);
+    void ecrire_decimal(double valeur, int precision); // Équivalent de fixed << setprecision(precision)
+    void vider();
+    std::string texte() const { return std::string(tampon.data(), taille); }
+    void effacer() { taille = 0; }
+    void detourner_cycles(RappelCycle rappel, void* contexte) { rappel_cycle = rappel; contexte_cycle = contexte; }
+    RappelCycle rappel_cycles() const { return rappel_cycle; }
+    void* contexte_cycles() const { return contexte_cycle; }
+
+private:
+    void faire_place(std::size_t longueur);
+
+    std::FILE* flux;
+    std::vector<char> tampon;
+    std::size_t taille = 0;
+    RappelCycle rappel_cycle = nullptr;
+    void* contexte_cycle = nullptr;
+};
+
+// Tampon partagé de la sortie standard, vidé à la fin du programme
+TamponSortie& sortie_standard();
+
+} // teleporteur
+
+#endif
@@ -1,51 +1,178 @@
 #include "teleporteur.h"
+#include "tampon_sortie.h"
+#include "texte_entree.h"
+#include "lecture_texte.h"
+#include "instrumentation.h"
+#include "politiques.h"
 
-#include <iostream>
-#include <iomanip> // Pour gérer l'affichage formaté
+#include <climits>
 #include <cmath>   // Pour abs()
+#include <algorithm>
+#include <cctype>
+#include <utility>
 
 using namespace std;
 
 namespace teleporteur
 {
 
-    static int cycles_neqli = 0, cycles_faneqli = 0;
-    static int deplacements_neqli = 0, deplacements_faneqli = 0;
-    static vector<double> attente_neqli, attente_faneqli;
     static const string BAD_DISPLAY_TYPE("Error: must be SHOW_CYCLES or SHOW_NO_CYCLE");
     static const string BAD_QUEUE_NB("Error: the number of queues must be strictly positive");
     static const string BAD_QUEUE_INDEX("Error: invalid queue index");
 
-    void print_error(string message)
+    void print_error(const string &message, TamponSortie &sortie)
     {
-        cout << message;
-        cout << endl;
-        exit(0);
+        sortie.ecrire(message);
+        sortie.ecrire('\n');
+        sortie.vider();
     }
 
-    void error(Parametres param, bool error_trouve)
+    // **Vérification des paramètres lus**
+    string verifier_parametres(const Parametres &param, bool error_trouve)
     {
         if (param.affichage_type != "SHOW_CYCLES" && param.affichage_type != "SHOW_NO_CYCLE")
         {
-            print_error("Error: must be SHOW_CYCLES or SHOW_NO_CYCLE");
+            return BAD_DISPLAY_TYPE;
         }
 
         if (param.nb_files <= 0)
         {
-            print_error("Error: the number of queues must be strictly positive");
+            return BAD_QUEUE_NB;
         }
 
         if (error_trouve)
-        {                                              // Si une erreur a été trouvée durant la lecture
-            print_error("Error: invalid queue index"); //
+        { // Si une erreur a été trouvée durant la lecture
+            return BAD_QUEUE_INDEX;
         }
+        return "";
+    }
+
+    // Affiche l'erreur éventuelle ; l'appelant décide de s'arrêter
+    bool error(const Parametres &param, bool error_trouve, TamponSortie &sortie)
+    {
+        string message = verifier_parametres(param, error_trouve);
+        if (message.empty())
+        {
+            return false;
+        }
+        print_error(message, sortie);
+        return true;
+    }
+
+    // Lit le couple suivant ; faux en fin de liste (-1 -1 ou fin du texte), vrai sinon.
+    // Un couple illisible ou hors des bornes positionne error_trouve.
+    static bool lire_robot(const char *&p, const char *fin, long long nb_files,
+                           long long &file, long long &sortie, bool &error_trouve)
+    {
+        if (sauter_blancs(p, fin) == fin)
+        {
+            return false;
+        }
+        if (!lire_entier(p, fin, file) || !lire_entier(p, fin, sortie))
+        {
+            error_trouve = true;
+            return false;
+        }
+        if (file == -1 && sortie == -1)
+        {
+            return false;
+        }
+        if (file < 0 or file >= nb_files or sortie < 0 or sortie >= nb_files)
+        {
+            error_trouve = true;
+            return false;
+        }
+        return true;
     }
 
     // **Lecture des paramètres**
-    bool lire_et_valider_parametres(Parametres &param, bool &error_trouve)
+    bool lire_et_valider_parametres(Parametres &param, bool &error_trouve, bool creux)
+    {
+        TexteEntree entree;
+        if (!entree.charger_descripteur(0)) // Entrée standard
+        {
+            param.affichage_type.clear();
+            return false;
+        }
+        return analyser_parametres(entree.debut(), entree.fin(), param, error_trouve, creux);
+    }
+
+    bool lire_et_valider_fichier(const string &chemin, Parametres &param, bool &error_trouve)
+    {
+        TexteEntree entree;
+        if (!entree.charger_fichier(chemin))
+        {
+            param.affichage_type.clear();
+            return false;
+        }
+        return analyser_parametres(entree.debut(), entree.fin(), param, error_trouve);
+    }
+
+    // **Lecture en mode creux**
+    // Une seule passe garde les couples lus ; les numéros de file rencontrés, triés,
+    // donnent les indices compacts. Mémoire et temps dépendent du nombre de robots,
+    // pas du nombre de files déclarées.
+    static bool analyser_creux(const char *p, const char *fin, long long nb_files, Parametres &param,
+                               bool &error_trouve)
+    {
+        vector<pair<long long, long long>> robots;
+        long long file, sortie;
+        while (lire_robot(p, fin, nb_files, file, sortie, error_trouve))
+        {
+            robots.emplace_back(file, sortie);
+        }
+        if (error_trouve)
+        {
+            return false;
+        }
+
+        vector<long long> &numeros = param.numeros;
+        numeros.reserve(2 * robots.size() + 1);
+        numeros.push_back(0); // File de départ du scanner
+        for (const auto &robot : robots)
+        {
+            numeros.push_back(robot.first);
+            numeros.push_back(robot.second);
+        }
+        sort(numeros.begin(), numeros.end());
+        numeros.erase(unique(numeros.begin(), numeros.end()), numeros.end());
+        numeros.shrink_to_fit();
+        param.nb_files = static_cast<int>(numeros.size());
+
+        auto indice = [&numeros](long long numero)
+        { return static_cast<long long>(lower_bound(numeros.begin(), numeros.end(), numero) - numeros.begin()); };
+        param.debuts.assign(param.nb_files + 1, 0);
+        int *debuts = param.debuts.modifier();
+        for (auto &robot : robots)
+        {
+            robot.first = indice(robot.first);
+            robot.second = indice(robot.second);
+            ++debuts[robot.first + 1];
+        }
+        for (int i = 0; i < param.nb_files; ++i)
+        {
+            debuts[i + 1] += debuts[i];
+        }
+        param.destinations.resize(robots.size());
+        int *destinations = param.destinations.modifier();
+        vector<int> positions(debuts, debuts + param.nb_files);
+        for (const auto &robot : robots)
+        {
+            destinations[positions[robot.first]++] = static_cast<int>(robot.second);
+        }
+        return true;
+    }
+
+    // Deux passes sur le texte : la première valide et compte les robots de chaque
+    // file, la seconde les range directement à leur place définitive.
+    bool analyser_parametres(const char *debut, const char *fin, Parametres &param, bool &error_trouve,
+                             bool creux)
     {
+        const char *p = debut;
+        param.numeros.clear();
+
         // Lecture du type d'affichage
-        cin >> param.affichage_type;
+        param.affichage_type = lire_mot(p, fin);
         if (param.affichage_type != "SHOW_CYCLES" && param.affichage_type != "SHOW_NO_CYCLE")
         {
             error_trouve = true; // Marquer l'erreur
@@ -53,467 +180,712 @@ namespace teleporteur
         }
 
         // Lecture du nombre de files
-        cin >> param.nb_files;
-        if (param.nb_files <= 0)
+        long long nb_files;
+        if (!lire_entier(p, fin, nb_files) || nb_files > (creux ? MAX_FILES_CREUSES : INT_MAX))
+        {
+            nb_files = 0;
+        }
+        if (nb_files <= 0)
         {
+            param.nb_files = 0;
             error_trouve = true; // Marquer l'erreur
             return false;
         }
-
-        // Initialisation des files d'attente
-        param.files.resize(param.nb_files);
-
-        // Lecture des robots et des files
-        int file, sortie;
-        while (true)
+        if (creux)
+        {
+            return analyser_creux(p, fin, nb_files, param, error_trouve);
+        }
+        param.nb_files = static_cast<int>(nb_files);
+
+        // Première passe : validation et comptage des robots par file
+        const char *debut_robots = p;
+        param.debuts.assign(param.nb_files + 1, 0);
+        int *debuts = param.debuts.modifier();
+        long long file, sortie;
+        while (lire_robot(p, fin, param.nb_files, file, sortie, error_trouve))
         {
-            cin >> file >> sortie;
+            ++debuts[file + 1];
+        }
+        if (error_trouve)
+        {
+            return false;
+        }
+        for (int i = 0; i < param.nb_files; ++i)
+        {
+            debuts[i + 1] += debuts[i];
+        }
 
-            // Condition de fin : -1 -1
-            if (file == -1 && sortie == -1)
-                break;
-            if (file < 0 or file >= param.nb_files or sortie < 0 or sortie >= param.nb_files)
-            {
-                error_trouve = true;
-                return false;
-            }
-            // Ajouter le robot dans la file correspondante
-            param.files[file].push(sortie);
+        // Seconde passe : rangement à plat, dans l'ordre d'arrivée de chaque file
+        param.destinations.resize(debuts[param.nb_files]);
+        int *destinations = param.destinations.modifier();
+        vector<int> positions(debuts, debuts + param.nb_files);
+        p = debut_robots;
+        while (lire_robot(p, fin, param.nb_files, file, sortie, error_trouve))
+        {
+            destinations[positions[file]++] = static_cast<int>(sortie);
         }
 
         return true; // Tous les paramètres sont valides
     }
 
     // **Affichage de l'état initial**
-    void afficher_etat_initial(const Parametres &param)
+    // En mode creux, seules les files qui ont des robots
+    void afficher_etat_initial(const Parametres &param, TamponSortie &sortie)
     {
-        cout << "Etat initial" << endl;
+        sortie.ecrire("Etat initial\n");
 
         // Parcours des files pour afficher leur contenu
-        for (size_t i = 0; i < param.files.size(); ++i)
+        for (int i = 0; i < param.nb_files; ++i)
         {
-            cout << i << "\t";                // Numéro de la file
-            queue<int> temp = param.files[i]; // Copie temporaire pour affichage
-            while (!temp.empty())
+            if (!param.numeros.empty() && param.debuts[i] == param.debuts[i + 1])
             {
-                cout << temp.front() << " "; // Affichage des destinations des robots
-                temp.pop();
+                continue;
             }
-            cout << endl;
+            sortie.ecrire_entier(param.numero(i)); // Numéro de la file
+            sortie.ecrire('\t');
+            for (int r = param.debuts[i]; r < param.debuts[i + 1]; ++r)
+            {
+                sortie.ecrire_entier(param.numero(param.destinations[r])); // Affichage des destinations des robots
+                sortie.ecrire(' ');
+            }
+            sortie.ecrire('\n');
         }
     }
 
     // **Affichage des cycles**
-    void afficher_cycle(int cycle, int depart, int arrivee, bool sortie, bool entree)
+    void afficher_cycle(TamponSortie *trace, long long cycle, long long depart, long long arrivee, bool sortie,
+                        bool entree)
     {
+        if (trace == nullptr) // SHOW_NO_CYCLE
+        {
+            return;
+        }
+        if (trace->rappel_cycles() != nullptr)
+        {
+            trace->rappel_cycles()(trace->contexte_cycles(), cycle, depart, arrivee, sortie, entree);
+            return;
+        }
         // Affichage des informations sur un cycle : numéro, départ, arrivée, actions
-        cout << depart << "\t" << arrivee << "\t"
-             << (sortie ? 1 : 0) << " " << (entree ? 1 : 0) << endl;
+        trace->ecrire_entier(depart);
+        trace->ecrire('\t');
+        trace->ecrire_entier(arrivee);
+        char actions[] = {'\t', sortie ? '1' : '0', ' ', entree ? '1' : '0', '\n'};
+        trace->ecrire(actions, sizeof(actions));
     }
 
-    // **Mise à jour des files non vides**
-    vector<bool> mettre_a_jour_files_non_vides(const Parametres &param)
+    // **Index d'occupation des files**
+    void IndexOccupation::initialiser(int nb)
     {
-        // Initialise un vecteur pour indiquer si chaque file est vide ou non
-        vector<bool> non_vides(param.nb_files, false);
-        for (size_t i = 0; i < param.files.size(); ++i)
+        nb_files = nb;
+        nb_marquees = 0;
+        niveaux.clear();
+        size_t nb_mots = max<size_t>(1, (static_cast<size_t>(nb) + 63) / 64);
+        while (true)
         {
-            if (!param.files[i].empty())
+            niveaux.emplace_back(nb_mots, 0);
+            if (nb_mots == 1)
             {
-                non_vides[i] = true;
+                break;
             }
+            nb_mots = (nb_mots + 63) / 64;
         }
-        return non_vides;
     }
 
-    // **Vérifie si toutes les files sont vides**
-    bool toutes_files_vides(const Parametres &param)
+    void IndexOccupation::marquer(int file)
     {
-        for (const auto &file : param.files)
+        size_t position = file;
+        if ((niveaux[0][position >> 6] >> (position & 63)) & 1)
+        {
+            return;
+        }
+        ++nb_marquees;
+        // On remonte tant que le mot modifié était nul avant
+        for (auto &niveau : niveaux)
         {
-            if (!file.empty())
+            uint64_t &mot = niveau[position >> 6];
+            bool etait_nul = (mot == 0);
+            mot |= uint64_t(1) << (position & 63);
+            if (!etait_nul)
             {
-                return false;
+                break;
             }
+            position >>= 6;
         }
-        return true;
     }
 
-    // **Affichage des statistiques finales**
-    void afficher_statistiques_finales()
+    void IndexOccupation::effacer(int file)
     {
-        cout << "Nombre de cycles" << endl;
-        cout << cycles_neqli << "\t" << cycles_faneqli << endl;
-
-        cout << "Déplacement total" << endl;
-        cout << deplacements_neqli << "\t" << deplacements_faneqli << endl;
-
-        cout << "Attente moyenne" << endl;
-        for (size_t i = 0; i < attente_neqli.size(); ++i)
+        size_t position = file;
+        if (!((niveaux[0][position >> 6] >> (position & 63)) & 1))
         {
-            cout << i << "\t";
-            if (attente_neqli[i] != 0)
-            {
-                cout << fixed << setprecision(2) << attente_neqli[i];
-            }
-            else
+            return;
+        }
+        --nb_marquees;
+        // On remonte tant que le mot modifié devient nul
+        for (auto &niveau : niveaux)
+        {
+            uint64_t &mot = niveau[position >> 6];
+            mot &= ~(uint64_t(1) << (position & 63));
+            if (mot != 0)
             {
-                cout << "";
+                break;
             }
+            position >>= 6;
+        }
+    }
 
-            if (attente_faneqli[i] != 0)
+    // Opérations atomiques sur les mots : des fils qui effacent des files différentes
+    // en même temps ne perdent aucune mise à jour. Un mot ne devient nul qu'une fois
+    // (aucun bit n'est remis), seul le fil qui l'a vidé remonte au niveau supérieur.
+    // Les lectures doivent attendre la fin des effacements (barrière entre fils).
+    void IndexOccupation::effacer_partage(int file)
+    {
+        size_t position = file;
+        for (size_t k = 0; k < niveaux.size(); ++k)
+        {
+            uint64_t bit = uint64_t(1) << (position & 63);
+            uint64_t avant = __atomic_fetch_and(&niveaux[k][position >> 6], ~bit, __ATOMIC_RELAXED);
+            if (k == 0)
             {
-                cout << "\t" << fixed << setprecision(2) << attente_faneqli[i] << endl;
+                if (!(avant & bit))
+                {
+                    return;
+                }
+                __atomic_fetch_sub(&nb_marquees, 1, __ATOMIC_RELAXED);
             }
-            else
+            if (avant != bit)
             {
-                cout << "\t" << endl;
+                break;
             }
+            position >>= 6;
         }
     }
 
-    // **Fonction pour stocker les résultats**
-    void stocker_resultats(int cycles, int deplacements,
-                           const vector<int> &somme_indices_cycles, const vector<int> &nb_robots_initial,
-                           int nb_files, int &cycles_resultat, int &deplacements_resultat,
-                           vector<double> &attente_resultat)
-    {
-        cycles_resultat = cycles;
-        deplacements_resultat = deplacements;
-        attente_resultat.resize(nb_files);
-        for (int i = 0; i < nb_files; ++i)
+    // Plus petit bit marqué >= position au niveau donné, -1 sinon
+    long long IndexOccupation::suivante_au_niveau(size_t niveau, size_t position) const
+    {
+        for (size_t k = niveau; k < niveaux.size(); ++k)
         {
-            attente_resultat[i] = nb_robots_initial[i] > 0
-                                      ? static_cast<double>(somme_indices_cycles[i]) / nb_robots_initial[i]
-                                      : 0.0;
+            size_t w = position >> 6;
+            if (w >= niveaux[k].size())
+            {
+                return -1;
+            }
+            uint64_t restants = niveaux[k][w] & (~uint64_t(0) << (position & 63));
+            if (restants != 0)
+            {
+                // Trouvé : on redescend vers le premier bit de chaque mot
+                position = w * 64 + __builtin_ctzll(restants);
+                while (k > niveau)
+                {
+                    --k;
+                    position = position * 64 + __builtin_ctzll(niveaux[k][position]);
+                }
+                return static_cast<long long>(position);
+            }
+            position = w + 1; // Mots suivants : on cherche au niveau supérieur
         }
+        return -1;
     }
 
-    // **Initialisation des variables**
-    void initialiser_variables(const Parametres &param, int &cycles, int &deplacements,
-                               int &scanner, int &robot_dans_scanner, vector<int> &somme_indices_cycles,
-                               vector<int> &nb_robots_initial)
+    int IndexOccupation::suivante(int file) const
     {
-        cycles = 0;
-        deplacements = 0;
-        scanner = 0;
-        robot_dans_scanner = -1;
-        somme_indices_cycles.resize(param.nb_files, 0);
-        nb_robots_initial.resize(param.nb_files, 0);
-
-        for (size_t i = 0; i < param.files.size(); ++i)
+        if (file >= nb_files)
         {
-            nb_robots_initial[i] = param.files[i].size();
+            return -1;
         }
+        return static_cast<int>(suivante_au_niveau(0, max(file, 0)));
     }
-    // début des fontions speicalement pour Neqli
 
-    // **Recherche de la prochaine file non vide**
-    int trouver_prochaine_file(const vector<bool> &non_vides)
+    int IndexOccupation::precedente(int file) const
     {
-        // Recherche la première file non vide
-        for (size_t i = 0; i < non_vides.size(); ++i)
+        if (file < 0)
+        {
+            return -1;
+        }
+        size_t position = min(file, nb_files - 1);
+        for (size_t k = 0; k < niveaux.size(); ++k)
         {
-            if (non_vides[i])
+            size_t w = position >> 6;
+            unsigned bit = position & 63;
+            uint64_t masque = bit == 63 ? ~uint64_t(0) : (uint64_t(1) << (bit + 1)) - 1;
+            uint64_t restants = niveaux[k][w] & masque;
+            if (restants != 0)
             {
-                return i;
+                // Trouvé : on redescend vers le dernier bit de chaque mot
+                position = w * 64 + 63 - __builtin_clzll(restants);
+                while (k > 0)
+                {
+                    --k;
+                    position = position * 64 + 63 - __builtin_clzll(niveaux[k][position]);
+                }
+                return static_cast<int>(position);
             }
+            if (w == 0)
+            {
+                return -1;
+            }
+            position = w - 1; // Mots précédents : on cherche au niveau supérieur
         }
-        return -1; // Aucune file non vide trouvée
+        return -1;
     }
 
-    // **Cas 1 : Scanner vide et file vide (NEQLI)**
-    void cas_1_neqli(int &scanner, int &deplacements, int &cycles, const vector<bool> &non_vides)
+    // **Mise à jour des files non vides**
+    void mettre_a_jour_files_non_vides(const Parametres &param, IndexOccupation &non_vides)
     {
-        int prochaine_file = trouver_prochaine_file(non_vides);
-        if (prochaine_file != -1)
+        // Un seul parcours au départ ; ensuite l'index suit les pop() des algorithmes
+        non_vides.initialiser(param.nb_files);
+        for (int i = 0; i < param.nb_files; ++i)
         {
-            int depart = scanner;
-            scanner = prochaine_file;
-            deplacements += abs(depart - scanner);
-            ++cycles;
-            afficher_cycle(cycles, depart, scanner, false, false);
+            if (param.debuts[i] != param.debuts[i + 1])
+            {
+                non_vides.marquer(i);
+            }
         }
     }
 
-    // **Cas 2 : Scanner vide et file pleine (NEQLI)**
-    void cas_2_neqli(int &scanner, int &deplacements, int &cycles,
-                     int &robot_dans_scanner, queue<int> &file,
-                     vector<int> &somme_indices_cycles)
+    // **Vérifie si toutes les files sont vides**
+    bool toutes_files_vides(const IndexOccupation &non_vides)
     {
-        robot_dans_scanner = file.front();
-        file.pop();
-        int depart = scanner;
-        scanner = robot_dans_scanner;
-        deplacements += abs(depart - scanner);
-        ++cycles;
-        afficher_cycle(cycles, depart, scanner, false, true);
-        somme_indices_cycles[depart] += cycles;
+        return non_vides.vide();
     }
 
-    // **Cas 3 : Scanner plein, file vide, bonne sortie (NEQLI)**
-    void cas_3_neqli(int &scanner, int &deplacements, int &cycles,
-                     int &robot_dans_scanner, const vector<bool> &non_vides)
+    // **Affichage des statistiques finales**
+    void afficher_statistiques_finales(const Resultats &resultats_neqli, const Resultats &resultats_faneqli,
+                                       TamponSortie &sortie)
     {
-        robot_dans_scanner = -1;
-        int prochaine_file = trouver_prochaine_file(non_vides);
-        if (prochaine_file != -1)
-        {
-            int depart = scanner;
-            scanner = prochaine_file;
-            deplacements += abs(depart - scanner);
-            ++cycles;
-            afficher_cycle(cycles, depart, scanner, true, false);
-        }
-        else
-        {
-            ++cycles;
-            afficher_cycle(cycles, scanner, scanner, true, false);
-        }
+        afficher_statistiques_finales(vector<Resultats>{resultats_neqli, resultats_faneqli}, sortie);
     }
 
-    // **Cas 4 : Scanner plein, file pleine, bonne sortie (NEQLI)**
-    void cas_4_neqli(int &scanner, int &deplacements, int &cycles,
-                     int &robot_dans_scanner, queue<int> &file, vector<int> &somme_indices_cycles)
+    // Vrai si la ligne de la file i est à écrire, avec le numéro à afficher
+    static bool file_affichee(const Parametres *param, size_t i, long long &numero)
     {
-        robot_dans_scanner = -1;
-        robot_dans_scanner = file.front();
-        file.pop();
-        int depart = scanner;
-        scanner = robot_dans_scanner;
-        deplacements += abs(depart - scanner);
-        ++cycles;
-        afficher_cycle(cycles, depart, scanner, true, true);
-        somme_indices_cycles[depart] += cycles;
+        numero = static_cast<long long>(i);
+        if (param == nullptr || param->numeros.empty())
+        {
+            return true;
+        }
+        numero = param->numeros[i];
+        return param->debuts[i] != param->debuts[i + 1];
     }
 
-    // **Algorithme NEQLI**
-    void neqli(Parametres &param)
+    void afficher_statistiques_finales(const vector<Resultats> &resultats, TamponSortie &sortie,
+                                       const Parametres *param)
     {
-        int cycles, deplacements, scanner, robot_dans_scanner;
-        vector<int> somme_indices_cycles, nb_robots_initial;
-
-        initialiser_variables(param, cycles, deplacements, scanner,
-                              robot_dans_scanner, somme_indices_cycles, nb_robots_initial);
-
-        while (!toutes_files_vides(param) || robot_dans_scanner != -1)
+        sortie.ecrire("Nombre de cycles\n");
+        for (size_t p = 0; p < resultats.size(); ++p)
         {
-            vector<bool> non_vides = mettre_a_jour_files_non_vides(param);
-
-            if (robot_dans_scanner == -1 && param.files[scanner].empty())
+            if (p > 0)
             {
-                cas_1_neqli(scanner, deplacements, cycles, non_vides);
+                sortie.ecrire('\t');
             }
-            else if (robot_dans_scanner == -1 && !param.files[scanner].empty())
+            sortie.ecrire_entier(resultats[p].cycles);
+        }
+        sortie.ecrire('\n');
+
+        sortie.ecrire("Déplacement total\n");
+        for (size_t p = 0; p < resultats.size(); ++p)
+        {
+            if (p > 0)
             {
-                cas_2_neqli(scanner, deplacements, cycles, robot_dans_scanner,
-                            param.files[scanner], somme_indices_cycles);
+                sortie.ecrire('\t');
             }
-            else if (robot_dans_scanner != -1 && param.files[scanner].empty() && scanner == robot_dans_scanner)
+            sortie.ecrire_entier(resultats[p].deplacements);
+        }
+        sortie.ecrire('\n');
+
+        sortie.ecrire("Attente moyenne\n");
+        size_t nb_files = resultats.empty() ? 0 : resultats[0].attente.size();
+        for (size_t i = 0; i < nb_files; ++i)
+        {
+            long long numero;
+            if (!file_affichee(param, i, numero))
             {
-                cas_3_neqli(scanner, deplacements, cycles, robot_dans_scanner, non_vides);
+                continue;
             }
-            else if (robot_dans_scanner != -1 && !param.files[scanner].empty() && scanner == robot_dans_scanner)
+            sortie.ecrire_entier(numero);
+            for (const Resultats &resultat : resultats)
             {
-                cas_4_neqli(scanner, deplacements, cycles, robot_dans_scanner,
-                            param.files[scanner], somme_indices_cycles);
+                sortie.ecrire('\t');
+                if (resultat.attente[i] != 0)
+                {
+                    sortie.ecrire_decimal(resultat.attente[i], 2);
+                }
             }
+            sortie.ecrire('\n');
         }
-
-        // Stocker les résultats
-        stocker_resultats(cycles, deplacements, somme_indices_cycles,
-                          nb_robots_initial, param.nb_files, cycles_neqli,
-                          deplacements_neqli, attente_neqli);
     }
 
-    // début des fonctions specialment pour faneqli
-
-    // **Recherche de la prochaine file non vide (FANEQLI)**
-    int trouver_prochaine_file_faneqli(const vector<bool> &non_vides,
-                                       const vector<bool> &done, int nb_files)
+    // p50 p90 p99 max séparés par des espaces, rien si l'esquisse est vide
+    static void ecrire_quantiles(const EsquisseAttente &esquisse, TamponSortie &sortie)
     {
-        for (int i = 0; i < nb_files; ++i)
+        if (esquisse.nombre() == 0)
         {
-            if (non_vides[i] && !done[i])
-            {
-                return i; // Retourne le plus petit indice trouvé
-            }
+            return;
         }
-        return -1; // Aucun indice valide trouvé
+        for (double q : {0.5, 0.9, 0.99})
+        {
+            sortie.ecrire_entier(esquisse.quantile(q));
+            sortie.ecrire(' ');
+        }
+        sortie.ecrire_entier(esquisse.maximum());
     }
 
-    // **Fonction pour vérifier si toutes les files ont été traitées (FANEQLI)**
-    bool toutes_files_traitees_faneqli(const vector<bool> &done, const Parametres &param)
+    // **Affichage des quantiles d'attente**
+    // Une colonne par politique, comme afficher_statistiques_finales() : d'abord
+    // toutes les files ensemble, puis chaque file si les esquisses par file existent.
+    void afficher_quantiles(const vector<Resultats> &resultats, TamponSortie &sortie, const Parametres *param)
     {
-        for (int i = 0; i < param.nb_files; ++i)
+        sortie.ecrire("Quantiles d'attente (p50 p90 p99 max)\n");
+        sortie.ecrire("total");
+        for (const Resultats &resultat : resultats)
         {
-            if (!done[i] && !param.files[i].empty())
+            sortie.ecrire('\t');
+            ecrire_quantiles(resultat.esquisse, sortie);
+        }
+        sortie.ecrire('\n');
+
+        size_t nb_files = resultats.empty() ? 0 : resultats[0].esquisses.size();
+        for (size_t i = 0; i < nb_files; ++i)
+        {
+            long long numero;
+            if (!file_affichee(param, i, numero))
             {
-                return false;
+                continue;
             }
+            sortie.ecrire_entier(numero);
+            for (const Resultats &resultat : resultats)
+            {
+                sortie.ecrire('\t');
+                ecrire_quantiles(resultat.esquisses[i], sortie);
+            }
+            sortie.ecrire('\n');
         }
-        return true;
     }
 
-    // **Fonction pour réinitialiser les files (FANEQLI)**
-    void reinitialiser_files_faneqli(vector<bool> &done, const Parametres &param)
+    // **Fonction pour stocker les résultats**
+    void stocker_resultats(long long cycles, long long deplacements,
+                           const vector<long long> &somme_indices_cycles, const vector<int> &nb_robots_initial,
+                           int nb_files, Resultats &resultats)
     {
-        vector<bool> non_vides = mettre_a_jour_files_non_vides(param);
-        for (int i = 0; i < param.nb_files; ++i)
+        resultats.cycles = cycles;
+        resultats.deplacements = deplacements;
+        resultats.attente.resize(nb_files);
+        for (int i = 0; i < nb_files; ++i)
         {
-            done[i] = !non_vides[i];
+            resultats.attente[i] = nb_robots_initial[i] > 0
+                                      ? static_cast<double>(somme_indices_cycles[i]) / nb_robots_initial[i]
+                                      : 0.0;
         }
     }
 
-    // **Fonction pour le Cas 1 : Scanner vide et file vide (FANEQLI)**
-    void cas_1_faneqli(int &scanner, int &deplacements, int &cycles,
-                       const vector<bool> &non_vides, const vector<bool> &done, Parametres &param)
+    // **Initialisation des variables**
+    void initialiser_variables(const Parametres &param, long long &cycles, long long &deplacements,
+                               int &scanner, int &robot_dans_scanner, vector<long long> &somme_indices_cycles,
+                               vector<int> &nb_robots_initial)
     {
-        int prochaine_file = trouver_prochaine_file_faneqli(non_vides, done, param.nb_files);
-        if (prochaine_file != -1)
+        cycles = 0;
+        deplacements = 0;
+        scanner = 0;
+        robot_dans_scanner = -1;
+        somme_indices_cycles.resize(param.nb_files, 0);
+        nb_robots_initial.resize(param.nb_files, 0);
+
+        for (int i = 0; i < param.nb_files; ++i)
         {
-            int depart = scanner;
-            scanner = prochaine_file;
-            deplacements += abs(depart - scanner);
-            ++cycles;
-            afficher_cycle(cycles, depart, scanner, false, false);
+            nb_robots_initial[i] = param.debuts[i + 1] - param.debuts[i];
         }
     }
+    // début des politiques d'ordonnancement
 
-    // **Fonction pour le Cas 2 : Scanner vide et file pleine (FANEQLI)**
-    void cas_2_faneqli(int &scanner, int &deplacements, int &cycles,
-                       int &robot_dans_scanner, queue<int> &file, vector<bool> &done,
-                       vector<int> &somme_indices_cycles, const vector<bool> &non_vides, Parametres &param)
+    // **Recherche de la prochaine file non vide**
+    int trouver_prochaine_file(const IndexOccupation &non_vides)
     {
+        // Recherche la première file non vide, -1 si aucune
+        return non_vides.premiere();
+    }
 
-        if (!done[scanner])
+    // **Moteur commun à toutes les politiques**
+    // Un cycle par tour de boucle (voir MoteurCycles::avancer()), avec la trace,
+    // les compteurs et les points de reprise.
+    template <class Politique>
+    static Resultats simuler(const Parametres &param, TamponSortie *trace, CompteursMoteur *compteurs,
+                             Quantiles quantiles, Reprise *reprise)
+    {
+        MoteurCycles<Politique> moteur(param, quantiles);
+        if (reprise != nullptr && reprise->depart != nullptr)
         {
-            robot_dans_scanner = file.front();
-            file.pop();
-            done[scanner] = true;
-            int depart = scanner;
-            scanner = robot_dans_scanner;
-            deplacements += abs(depart - scanner);
-            ++cycles;
-            afficher_cycle(cycles, depart, scanner, false, true);
-            somme_indices_cycles[depart] += cycles;
+            restaurer_etat(*reprise->depart, moteur.cycles, moteur.deplacements, moteur.scanner,
+                           moteur.robot_dans_scanner, moteur.files, moteur.somme_indices_cycles, moteur.non_vides,
+                           moteur.politique);
         }
-        else
+        bool sauver = reprise != nullptr && reprise->ecrivain != nullptr;
+        long long prochain_point = sauver ? moteur.cycles + reprise->ecrivain->intervalle() : LLONG_MAX;
+
+        while (!moteur.termine())
         {
-            int prochaine_file = trouver_prochaine_file_faneqli(non_vides, done,
-                                                                param.nb_files);
-            if (prochaine_file != -1)
+            if (moteur.cycles >= prochain_point)
             {
-                int depart = scanner;
-                scanner = prochaine_file;
-                deplacements += abs(depart - scanner);
-                ++cycles;
-                afficher_cycle(cycles, depart, scanner, false, false);
+                publier_etat(*reprise, moteur.cycles, moteur.deplacements, moteur.scanner, moteur.robot_dans_scanner,
+                             moteur.files, moteur.somme_indices_cycles, moteur.politique);
+                prochain_point = moteur.cycles + reprise->ecrivain->intervalle();
             }
+            PasMoteur pas = moteur.avancer();
+            compter_cycle(compteurs, pas.sortie, pas.entree, pas.distance);
+            afficher_cycle(trace, moteur.cycles, param.numero(pas.depart), param.numero(moteur.scanner), pas.sortie,
+                           pas.entree);
         }
+        if (sauver)
+        {
+            // État final : une reprise après la fin rend directement les résultats
+            publier_etat(*reprise, moteur.cycles, moteur.deplacements, moteur.scanner, moteur.robot_dans_scanner,
+                         moteur.files, moteur.somme_indices_cycles, moteur.politique);
+            reprise->ecrivain->attendre();
+        }
+        return moteur.resultats();
     }
 
-    // **Fonction pour le Cas 3 : Scanner plein, file vide, bonne sortie (FANEQLI)**
-    void cas_3_faneqli(int &scanner, int &deplacements, int &cycles,
-                       int &robot_dans_scanner, const vector<bool> &non_vides, vector<bool> &done,
-                       Parametres &param)
+    // **Moteur pour peu de files**
+    // Sans point de reprise à lire ni à écrire, les moteurs à masques de
+    // petites_files.cpp remplacent simuler<Politique>() quand toutes les files
+    // tiennent dans un mot.
+    static bool petites_files(const Parametres &param, const Reprise *reprise)
     {
-        robot_dans_scanner = -1;
-        int prochaine_file = trouver_prochaine_file_faneqli(non_vides, done, param.nb_files);
-        if (prochaine_file != -1)
+        return param.nb_files <= MAX_PETITES_FILES &&
+               (reprise == nullptr || (reprise->depart == nullptr && reprise->ecrivain == nullptr));
+    }
+
+    // **Algorithme NEQLI**
+    Resultats neqli(const Parametres &param, TamponSortie *trace, CompteursMoteur *compteurs, Quantiles quantiles,
+                    Reprise *reprise)
+    {
+        // Rien à afficher : inutile de passer cycle par cycle. Le moteur rapide ne reprend
+        // qu'un état où le scanner est vide ; ceux qu'il écrit au milieu d'une suite de
+        // chargements, robot à bord, reprennent cycle par cycle.
+        if (trace == nullptr &&
+            (reprise == nullptr || reprise->depart == nullptr || reprise->depart->robot_dans_scanner == -1))
         {
-            int depart = scanner;
-            scanner = prochaine_file;
-            deplacements += abs(depart - scanner);
-            ++cycles;
-            afficher_cycle(cycles, depart, scanner, true, false);
+            return neqli_rapide(param, compteurs, quantiles, reprise);
         }
-        else
+        if (petites_files(param, reprise))
         {
-            ++cycles;
-            afficher_cycle(cycles, scanner, scanner, true, false);
+            return simuler_petites_files(TypePolitique::neqli, param, trace, compteurs, quantiles);
         }
+        return simuler<PolitiqueNeqli>(param, trace, compteurs, quantiles, reprise);
     }
-    // fonction pour le cas 4
-    void cas_4_faneqli(int &scanner, int &deplacements, int &cycles,
-                       int &robot_dans_scanner, const vector<bool> &non_vides,
-                       vector<bool> &done, Parametres &param,
-                       vector<int> &somme_indices_cycles)
+
+    // **Algorithme FANEQLI**
+    Resultats faneqli(const Parametres &param, TamponSortie *trace, CompteursMoteur *compteurs, Quantiles quantiles,
+                      Reprise *reprise)
     {
-        if (robot_dans_scanner != -1)
+        if (petites_files(param, reprise))
         {
-            if (!done[scanner])
-            {
-                robot_dans_scanner = param.files[scanner].front();
-                param.files[scanner].pop();
-                int depart = scanner;
-                scanner = robot_dans_scanner;
-                deplacements += abs(depart - scanner);
-                ++cycles;
-                afficher_cycle(cycles, depart, scanner, true, true);
-                somme_indices_cycles[depart] += cycles;
-                done[depart] = true;
-            }
-            else
+            return simuler_petites_files(TypePolitique::faneqli, param, trace, compteurs, quantiles);
+        }
+        return simuler<PolitiqueFaneqli>(param, trace, compteurs, quantiles, reprise);
+    }
+
+    // **Algorithme SSTF**
+    Resultats sstf(const Parametres &param, TamponSortie *trace, CompteursMoteur *compteurs, Quantiles quantiles,
+                   Reprise *reprise)
+    {
+        if (petites_files(param, reprise))
+        {
+            return simuler_petites_files(TypePolitique::sstf, param, trace, compteurs, quantiles);
+        }
+        return simuler<PolitiqueSstf>(param, trace, compteurs, quantiles, reprise);
+    }
+
+    // **Algorithme SCAN**
+    Resultats scan(const Parametres &param, TamponSortie *trace, CompteursMoteur *compteurs, Quantiles quantiles,
+                   Reprise *reprise)
+    {
+        if (petites_files(param, reprise))
+        {
+            return simuler_petites_files(TypePolitique::scan, param, trace, compteurs, quantiles);
+        }
+        return simuler<PolitiqueScan>(param, trace, compteurs, quantiles, reprise);
+    }
+
+    // **Choix d'une politique à l'exécution**
+    static const char *const NOMS_POLITIQUES[] = {"NEQLI", "FANEQLI", "SSTF", "SCAN"};
+
+    const char *nom_politique(TypePolitique politique)
+    {
+        return NOMS_POLITIQUES[static_cast<int>(politique)];
+    }
+
+    bool lire_politique(const string &nom, TypePolitique &politique)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            string nom_connu = NOMS_POLITIQUES[i];
+            if (nom.size() == nom_connu.size() &&
+                equal(nom.begin(), nom.end(), nom_connu.begin(),
+                      [](char a, char b) { return toupper(static_cast<unsigned char>(a)) == b; }))
             {
-                // File déjà traitée
-                int prochaine_file = trouver_prochaine_file_faneqli(non_vides, done, param.nb_files);
-                if (prochaine_file != -1)
-                {
-                    robot_dans_scanner = -1;
-                    int depart = scanner;
-                    scanner = prochaine_file;
-                    deplacements += abs(depart - scanner);
-                    ++cycles;
-                    afficher_cycle(cycles, depart, scanner, true, false);
-                }
+                politique = static_cast<TypePolitique>(i);
+                return true;
             }
         }
+        return false;
     }
 
-    // **Algorithme FANEQLI**
-    void faneqli(Parametres &param)
+    static Resultats executer_politique(TypePolitique politique, const Parametres &param, TamponSortie *trace,
+                                        CompteursMoteur *compteurs, Quantiles quantiles, Reprise *reprise)
     {
-        int cycles, deplacements, scanner, robot_dans_scanner;
-        vector<int> somme_indices_cycles, nb_robots_initial;
+        switch (politique)
+        {
+        case TypePolitique::neqli:
+            return neqli(param, trace, compteurs, quantiles, reprise);
+        case TypePolitique::faneqli:
+            return faneqli(param, trace, compteurs, quantiles, reprise);
+        case TypePolitique::sstf:
+            return sstf(param, trace, compteurs, quantiles, reprise);
+        case TypePolitique::scan:
+            return scan(param, trace, compteurs, quantiles, reprise);
+        }
+        return Resultats();
+    }
 
-        // Initialiser les variables
+    Resultats simuler_politique(TypePolitique politique, const Parametres &param, TamponSortie *trace,
+                                CompteursMoteur *compteurs, Quantiles quantiles, Reprise *reprise)
+    {
+        if (!INSTRUMENTATION_COMPILEE || compteurs == nullptr)
+        {
+            return executer_politique(politique, param, trace, nullptr, quantiles, reprise);
+        }
+        Chronometre chronometre;
+        Resultats resultats = executer_politique(politique, param, trace, compteurs, quantiles, reprise);
+        compteurs->secondes += chronometre.secondes();
+        return resultats;
+    }
+
+    // début du moteur rapide (SHOW_NO_CYCLE)
+
+    // **NEQLI par événements**
+    // Un chargement (cas 2 ou cas 4) et un déchargement sans reprise (cas 3) coûtent
+    // chacun un cycle ; les robots qui restent dans leur propre file se suivent sans
+    // déplacement et sont comptés d'un bloc.
+    Resultats neqli_rapide(const Parametres &param, CompteursMoteur *compteurs, Quantiles quantiles,
+                           Reprise *reprise)
+    {
+        long long cycles, deplacements;
+        int scanner, robot_dans_scanner;
+        vector<long long> somme_indices_cycles;
+        vector<int> nb_robots_initial;
         initialiser_variables(param, cycles, deplacements, scanner,
                               robot_dans_scanner, somme_indices_cycles, nb_robots_initial);
+        CurseursFiles files;
+        files.initialiser(param);
+        IndexOccupation non_vides;
+        mettre_a_jour_files_non_vides(param, non_vides);
+        const int *destinations = param.destinations.data();
+        EsquissesMoteur esquisses(quantiles, param.nb_files);
+        PolitiqueNeqli politique;
+        if (reprise != nullptr && reprise->depart != nullptr)
+        {
+            restaurer_etat(*reprise->depart, cycles, deplacements, scanner, robot_dans_scanner,
+                           files, somme_indices_cycles, non_vides, politique);
+        }
+        bool sauver = reprise != nullptr && reprise->ecrivain != nullptr;
+        long long prochain_point = sauver ? cycles + reprise->ecrivain->intervalle() : LLONG_MAX;
 
-        // Ajout du vecteur done pour gérer les tours
-        vector<bool> done(param.nb_files, false);
-
-        while (!toutes_files_vides(param) || robot_dans_scanner != -1)
+        if (!non_vides.vide() && files.vide(scanner))
         {
-            vector<bool> non_vides = mettre_a_jour_files_non_vides(param);
+            // Cas 1 : déplacement à vide vers la première file non vide
+            int prochaine_file = trouver_prochaine_file(non_vides);
+            compter_cycle(compteurs, false, false, param.distance(scanner, prochaine_file));
+            deplacements += param.distance(scanner, prochaine_file);
+            scanner = prochaine_file;
+            ++cycles;
+        }
 
-            if (toutes_files_traitees_faneqli(done, param))
-            {
-                reinitialiser_files_faneqli(done, param);
-            }
-            if (robot_dans_scanner == -1 && param.files[scanner].empty())
-            {
-                cas_1_faneqli(scanner, deplacements, cycles, non_vides, done, param);
-            }
-            else if (robot_dans_scanner == -1 && !param.files[scanner].empty())
+        while (!non_vides.vide())
+        {
+            // Ici le scanner est vide
+            if (cycles >= prochain_point)
             {
-                cas_2_faneqli(scanner, deplacements, cycles, robot_dans_scanner,
-                              param.files[scanner], done, somme_indices_cycles, non_vides, param);
+                publier_etat(*reprise, cycles, deplacements, scanner, -1,
+                             files, somme_indices_cycles, politique);
+                prochain_point = cycles + reprise->ecrivain->intervalle();
             }
-            else if (robot_dans_scanner != -1 && param.files[scanner].empty() && scanner == robot_dans_scanner)
+            // Scanner vide devant une file non vide : chargements enchaînés tant que
+            // la file d'arrivée a encore des robots
+            bool scanner_vide = true;
+            do
             {
-                cas_3_faneqli(scanner, deplacements, cycles,
-                              robot_dans_scanner, non_vides, done, param);
-            }
-            else if (robot_dans_scanner != -1)
+                int depart = scanner;
+                int &position = files.positions[depart];
+                int fin = param.debuts[depart + 1];
+                if (destinations[position] == depart)
+                {
+                    // Suite de k robots pour leur propre file : cycles c+1 .. c+k
+                    int k = 1;
+                    while (position + k < fin && destinations[position + k] == depart)
+                    {
+                        ++k;
+                    }
+                    somme_indices_cycles[depart] += k * cycles + static_cast<long long>(k) * (k + 1) / 2;
+                    for (int j = 1; quantiles != Quantiles::aucun && j <= k; ++j)
+                    {
+                        esquisses.ajouter(depart, cycles + j);
+                    }
+                    if (INSTRUMENTATION_COMPILEE && compteurs != nullptr)
+                    {
+                        compteurs->compter_cycle(2, scanner_vide ? 1 : 0);
+                        compteurs->compter_cycle(4, scanner_vide ? k - 1 : k);
+                        compteurs->compter_saut(0, k);
+                    }
+                    cycles += k;
+                    position += k;
+                }
+                else
+                {
+                    scanner = destinations[position++];
+                    deplacements += param.distance(depart, scanner);
+                    ++cycles;
+                    somme_indices_cycles[depart] += cycles;
+                    esquisses.ajouter(depart, cycles);
+                    compter_cycle(compteurs, !scanner_vide, true, param.distance(depart, scanner));
+                }
+                scanner_vide = false;
+                if (position == fin)
+                {
+                    non_vides.effacer(depart);
+                }
+                // Une suite de chargements peut durer presque toute la simulation : le
+                // robot chargé en dernier est à bord, devant sa sortie
+                if (cycles >= prochain_point)
+                {
+                    publier_etat(*reprise, cycles, deplacements, scanner, scanner,
+                                 files, somme_indices_cycles, politique);
+                    prochain_point = cycles + reprise->ecrivain->intervalle();
+                }
+            } while (!files.vide(scanner));
+
+            // Cas 3 : déchargement, puis départ vers la première file non vide s'il en reste
+            ++cycles;
+            int prochaine_file = trouver_prochaine_file(non_vides);
+            compter_cycle(compteurs, true, false, prochaine_file != -1 ? param.distance(scanner, prochaine_file) : 0);
+            if (prochaine_file != -1)
             {
-                cas_4_faneqli(scanner, deplacements, cycles,
-                              robot_dans_scanner, non_vides, done, param, somme_indices_cycles);
+                deplacements += param.distance(scanner, prochaine_file);
+                scanner = prochaine_file;
             }
         }
-        stocker_resultats(cycles, deplacements, somme_indices_cycles, nb_robots_initial,
-                          param.nb_files, cycles_faneqli, deplacements_faneqli, attente_faneqli);
+        if (sauver)
+        {
+            publier_etat(*reprise, cycles, deplacements, scanner, -1, files, somme_indices_cycles, politique);
+            reprise->ecrivain->attendre();
+        }
+
+        Resultats resultats;
+        stocker_resultats(cycles, deplacements, somme_indices_cycles,
+                          nb_robots_initial, param.nb_files, resultats);
+        esquisses.ranger(resultats);
+        return resultats;
     }
 
+
 } // teleporteur
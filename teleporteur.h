@@ -1,71 +1,244 @@
+#ifndef TELEPORTEUR_H
+#define TELEPORTEUR_H
+
+#include "esquisse_attente.h"
+
 #include <vector>
-#include <queue>
 #include <string>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
 
 
 namespace teleporteur {
 
+class TamponSortie;
+struct CompteursMoteur;
+struct Reprise;
+
+// **Tableau possédé ou emprunté**
+// Comme un std::vector pour la lecture ; emprunter() le fait pointer sur la
+// mémoire de l'appelant, sans copie, qui doit rester valable tant que le tableau
+// sert. Un tableau emprunté n'est jamais modifié : il est d'abord recopié.
+template <class T>
+class Tableau
+{
+public:
+    Tableau() = default;
+    Tableau(const Tableau& autre) { *this = autre; }
+    Tableau(Tableau&& autre) noexcept { *this = std::move(autre); }
+    Tableau& operator=(const Tableau& autre)
+    {
+        if (this != &autre)
+        {
+            if (autre.possede())
+            {
+                stockage = autre.stockage;
+                suivre();
+            }
+            else
+            {
+                emprunter(autre.debut, autre.nb);
+            }
+        }
+        return *this;
+    }
+    Tableau& operator=(Tableau&& autre) noexcept
+    {
+        if (autre.possede())
+        {
+            stockage = std::move(autre.stockage); // Même mémoire : debut reste juste
+            suivre();
+        }
+        else
+        {
+            emprunter(autre.debut, autre.nb);
+        }
+        autre.clear();
+        return *this;
+    }
+
+    void assign(std::size_t n, const T& valeur) { stockage.assign(n, valeur); suivre(); }
+    void resize(std::size_t n) { posseder(); stockage.resize(n); suivre(); }
+    void clear() { stockage.clear(); suivre(); }
+    void emprunter(const T* donnees, std::size_t taille)
+    {
+        std::vector<T>().swap(stockage);
+        debut = donnees;
+        nb = taille;
+    }
+
+    // Écriture : le tableau devient propriétaire une fois, avant la boucle qui remplit
+    T* modifier() { posseder(); return stockage.data(); }
+    const T& operator[](std::size_t i) const { return debut[i]; }
+    const T* data() const { return debut; }
+    std::size_t size() const { return nb; }
+    bool empty() const { return nb == 0; }
+    const T* begin() const { return debut; }
+    const T* end() const { return debut + nb; }
+
+private:
+    bool possede() const { return debut == stockage.data(); }
+    void suivre() { debut = stockage.data(); nb = stockage.size(); }
+    void posseder()
+    {
+        if (!possede())
+        {
+            stockage.assign(debut, debut + nb);
+            suivre();
+        }
+    }
+
+    std::vector<T> stockage;
+    const T* debut = nullptr;
+    std::size_t nb = 0;
+};
+
 // **Structure des paramètres**
+// Les files sont stockées à plat (format CSR) : les robots de la file i sont
+// destinations[debuts[i]] .. destinations[debuts[i + 1] - 1], tête de file en premier.
+// Ces données ne changent plus après la lecture ; chaque algorithme avance ses
+// propres curseurs (CurseursFiles) au lieu de vider une copie des files.
+// En mode creux, seules les files qui servent (départ ou destination d'un robot,
+// et la file 0 d'où part le scanner) existent : la file i est celle de numéro
+// numeros[i], dans le même ordre. Les moteurs travaillent sur les indices i et
+// ne passent par numero() et distance() que pour les déplacements et l'affichage.
 struct Parametres {
     std::string affichage_type;        // Type d'affichage : SHOW_CYCLES ou SHOW_NO_CYCLES
     int nb_files;                 // Nombre de files d'attente
-    std::vector<std::queue<int>> files;    // Files d'attente, chaque file est une std::queue
+    Tableau<int> destinations;         // Destinations de tous les robots, file après file
+    Tableau<int> debuts;               // nb_files + 1 positions de début dans destinations
+    std::vector<long long> numeros;    // Mode creux : numéro de chaque file, croissant ; vide sinon
+
+    long long numero(int file) const { return numeros.empty() ? file : numeros[file]; }
+    long long distance(int a, int b) const { return numeros.empty() ? std::abs(a - b) : std::llabs(numeros[a] - numeros[b]); }
 };
 
-// **Prototypes des fonctions**
-bool lire_et_valider_parametres(Parametres& param,bool& error_trouve); 
-void afficher_etat_initial(const Parametres& param);
-void neqli(Parametres& param);                     
-void print_error(std::string message);
-void error (Parametres param, bool error_trouve);
-void afficher_cycle(int cycle, int depart, int arrivee, bool sortie, bool entree); 
-std::vector<bool> mettre_a_jour_files_non_vides(const Parametres& param);            
-bool toutes_files_vides(const Parametres& param);                                
-int trouver_prochaine_file_faneqli(const std::vector<bool>& non_vides, 
-const std::vector<bool>& done, int nb_files);
-
-void faneqli(Parametres& param);
-void afficher_cycle(int cycle, int depart, int arrivee, bool sortie, bool entree); 
-void afficher_statistiques_finales();
-void cas_1_neqli(int& scanner, int& deplacements, int& cycles,
- const std::vector<bool>& non_vides);
- 
-void cas_2_neqli(int& scanner, int& deplacements, int& cycles, 
-int& robot_dans_scanner, std::queue<int>& file, std::vector<int>& somme_indices_cycles);
+const long long MAX_FILES_CREUSES = 1000000000000000000LL; // 10^18 files déclarées au plus en mode creux
 
-void cas_3_neqli(int& scanner, int& deplacements, int& cycles, 
-int& robot_dans_scanner, const std::vector<bool>& non_vides);
+// **Curseurs de lecture d'un algorithme sur les files de Parametres**
+struct CurseursFiles {
+    const Parametres* param = nullptr;
+    std::vector<int> positions;        // Prochain robot à sortir de chaque file
 
-void cas_4_neqli(int& scanner, int& deplacements,int& cycles, int& robot_dans_scanner,
- std::queue<int>& file, std::vector<int>& somme_indices_cycles);
- 
-void stocker_resultats(int cycles, int deplacements,
- const std::vector<int>& somme_indices_cycles, const std::vector<int>& nb_robots_initial, 
- int nb_files, int& cycles_resultat, int& deplacements_resultat, 
- std::vector<double>& attente_resultat);
- 
-void initialiser_variables(const Parametres& param, int& cycles, int& deplacements, 
-int& scanner, int& robot_dans_scanner, 
-std::vector<int>& somme_indices_cycles, std::vector<int>& nb_robots_initial);
+    void initialiser(const Parametres& p) { param = &p; positions.assign(p.debuts.begin(), p.debuts.end() - 1); }
+    bool vide(int file) const { return positions[file] == param->debuts[file + 1]; }
+    int tete(int file) const { return param->destinations[positions[file]]; }
+    void retirer(int file) { ++positions[file]; }
+};
 
-bool toutes_files_traitees_faneqli(const std::vector<bool>& done,const Parametres& param);
-void reinitialiser_files_faneqli(std::vector<bool>& done, const Parametres& param);
+// **Index d'occupation des files**
+// Un bit par file dans des mots de 64 bits, mis à jour seulement quand une file
+// devient vide ou non vide. Au-dessus, chaque niveau a un bit par mot non nul du
+// niveau inférieur : la file marquée la plus proche d'un indice, dans un sens ou
+// dans l'autre, se trouve en O(log64 nb_files) avec count-trailing/leading-zeros.
+class IndexOccupation
+{
+public:
+    void initialiser(int nb_files);
+    void marquer(int file);
+    void effacer(int file);
+    void effacer_partage(int file);                             // effacer() sûr entre fils qui ne font qu'effacer
+    bool contient(int file) const { return (niveaux[0][file >> 6] >> (file & 63)) & 1; }
+    bool vide() const { return nb_marquees == 0; }
+    int nombre() const { return nb_marquees; }
+    int premiere() const { return suivante(0); }                // -1 si aucune file marquée
+    int suivante(int file) const;                               // plus petite marquée >= file, -1 sinon
+    int precedente(int file) const;                             // plus grande marquée <= file, -1 sinon
 
-void cas_1_faneqli(int& scanner, int& deplacements, int& cycles, 
-const std::vector<bool>& non_vides, const std::vector<bool>& done, Parametres& param);
+private:
+    long long suivante_au_niveau(std::size_t niveau, std::size_t position) const;
 
+    std::vector<std::vector<std::uint64_t>> niveaux; // niveaux[0] : un bit par file
+    int nb_files = 0;
+    int nb_marquees = 0;
+};
 
+// **Résultats d'un algorithme**
+// Rendus par neqli() et faneqli() : rien n'est conservé entre deux exécutions,
+// les deux algorithmes peuvent donc tourner en même temps sur les mêmes Parametres.
+struct Resultats {
+    long long cycles = 0;
+    long long deplacements = 0;
+    std::vector<double> attente;       // Attente moyenne par file, 0 si la file était vide
+    EsquisseAttente esquisse;          // Distribution des attentes de toutes les files, si demandée
+    std::vector<EsquisseAttente> esquisses; // La même pour chaque file, si demandée
+};
 
-void cas_2_faneqli(int& scanner, int& deplacements, int& cycles, 
-int& robot_dans_scanner, std::queue<int>& file, std::vector<bool>& done,
- std::vector<int>& somme_indices_cycles, const std::vector<bool>& non_vides,Parametres& param);
- 
-void cas_3_faneqli(int& scanner, int& deplacements, int& cycles, 
-int& robot_dans_scanner, const std::vector<bool>& non_vides, std::vector<bool>& done,
- Parametres& param);
+// **Distribution des attentes à calculer**
+// global : une esquisse par politique, quelques ko qui restent en cache ;
+// par_file : en plus une esquisse par file, dont la taille croît avec le
+// logarithme de la plus longue attente de la file.
+enum class Quantiles { aucun, global, par_file };
+
+// **Politiques d'ordonnancement**
+// NEQLI et FANEQLI sont celles de l'énoncé ; SSTF part vers la file non vide la
+// plus proche du scanner et SCAN balaie les files comme un ascenseur.
+enum class TypePolitique { neqli, faneqli, sstf, scan };
+
+// **Prototypes des fonctions**
+bool lire_et_valider_parametres(Parametres& param,bool& error_trouve, bool creux = false); 
+bool lire_et_valider_fichier(const std::string& chemin, Parametres& param, bool& error_trouve);
+bool analyser_parametres(const char* debut, const char* fin, Parametres& param, bool& error_trouve,
+ bool creux = false);                                           // creux : numéros de file sur 64 bits
+void afficher_etat_initial(const Parametres& param, TamponSortie& sortie);
+Resultats neqli(const Parametres& param, TamponSortie* trace,   // trace nulle : cycles non affichés
+ CompteursMoteur* compteurs = nullptr,                          // compteurs nuls : pas d'instrumentation
+ Quantiles quantiles = Quantiles::aucun,                        // Remplit aussi les esquisses de Resultats
+ Reprise* reprise = nullptr);                                   // Point de départ et points de reprise
+std::string verifier_parametres(const Parametres& param, bool error_trouve); // Message d'erreur, vide si valides
+void print_error(const std::string& message, TamponSortie& sortie);
+bool error (const Parametres& param, bool error_trouve, TamponSortie& sortie);
+void afficher_cycle(TamponSortie* trace, long long cycle, long long depart, long long arrivee, bool sortie, bool entree); 
+void mettre_a_jour_files_non_vides(const Parametres& param, IndexOccupation& non_vides);
+bool toutes_files_vides(const IndexOccupation& non_vides);
+int trouver_prochaine_file(const IndexOccupation& non_vides);
+
+Resultats faneqli(const Parametres& param, TamponSortie* trace, CompteursMoteur* compteurs = nullptr,
+ Quantiles quantiles = Quantiles::aucun, Reprise* reprise = nullptr);
+Resultats sstf(const Parametres& param, TamponSortie* trace, CompteursMoteur* compteurs = nullptr,
+ Quantiles quantiles = Quantiles::aucun, Reprise* reprise = nullptr);
+Resultats scan(const Parametres& param, TamponSortie* trace, CompteursMoteur* compteurs = nullptr,
+ Quantiles quantiles = Quantiles::aucun, Reprise* reprise = nullptr);
+Resultats simuler_politique(TypePolitique politique, const Parametres& param, TamponSortie* trace,
+ CompteursMoteur* compteurs = nullptr, Quantiles quantiles = Quantiles::aucun, // Avec compteurs, mesure aussi la durée
+ Reprise* reprise = nullptr);
+const char* nom_politique(TypePolitique politique);                  // "NEQLI", "FANEQLI", ...
+bool lire_politique(const std::string& nom, TypePolitique& politique); // Nom sans tenir compte de la casse
+
+// Moteur rapide sans trace : saute d'un événement à l'autre et compte d'un bloc les
+// robots qui restent dans leur file, avec exactement les mêmes statistiques.
+// neqli() l'utilise quand trace est nulle.
+Resultats neqli_rapide(const Parametres& param, CompteursMoteur* compteurs = nullptr,
+ Quantiles quantiles = Quantiles::aucun, Reprise* reprise = nullptr);
+
+// Moteurs pour au plus MAX_PETITES_FILES files : occupation et tours de FANEQLI dans
+// un mot de 64 bits, curseurs dans des std::array. Mêmes traces et résultats que le
+// moteur générique, sans points de reprise ; neqli(), faneqli(), sstf() et scan()
+// les choisissent d'eux-mêmes.
+const int MAX_PETITES_FILES = 64;
+Resultats simuler_petites_files(TypePolitique politique, const Parametres& param, TamponSortie* trace,
+ CompteursMoteur* compteurs = nullptr, Quantiles quantiles = Quantiles::aucun);
+void afficher_statistiques_finales(const Resultats& resultats_neqli, const Resultats& resultats_faneqli,
+ TamponSortie& sortie);
+// Une colonne par politique ; avec param en mode creux, seules les files qui avaient
+// des robots, sous leur numéro
+void afficher_statistiques_finales(const std::vector<Resultats>& resultats, TamponSortie& sortie,
+ const Parametres* param = nullptr);
+void afficher_quantiles(const std::vector<Resultats>& resultats, TamponSortie& sortie, // p50 p90 p99 max
+ const Parametres* param = nullptr);
+
+void stocker_resultats(long long cycles, long long deplacements,
+ const std::vector<long long>& somme_indices_cycles, const std::vector<int>& nb_robots_initial, 
+ int nb_files, Resultats& resultats);
  
-void cas_4_faneqli(int& scanner, int& deplacements, int& cycles, 
-                   int& robot_dans_scanner, const std::vector<bool>& non_vides, 
-                   std::vector<bool>& done, Parametres& param, std::vector<int>& somme_indices_cycles);
+void initialiser_variables(const Parametres& param, long long& cycles, long long& deplacements, 
+int& scanner, int& robot_dans_scanner, 
+std::vector<long long>& somme_indices_cycles, std::vector<int>& nb_robots_initial);
+
+
 
 } // teleporteur
+
+#endif
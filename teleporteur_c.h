@@ -0,0 +1,53 @@
+#ifndef TELEPORTEUR_C_H
+#define TELEPORTEUR_C_H
+
+/* Interface C de la bibliothèque : voir bibliotheque.h pour l'interface C++. */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Politiques, dans l'ordre de teleporteur::TypePolitique */
+enum {
+    TELEPORTEUR_NEQLI = 0,
+    TELEPORTEUR_FANEQLI = 1,
+    TELEPORTEUR_SSTF = 2,
+    TELEPORTEUR_SCAN = 3
+};
+
+/* Codes de retour de teleporteur_simuler() */
+enum {
+    TELEPORTEUR_OK = 0,
+    TELEPORTEUR_ERREUR_POLITIQUE = 1,   /* Politique inconnue */
+    TELEPORTEUR_ERREUR_NB_FILES = 2,    /* nb_files <= 0 */
+    TELEPORTEUR_ERREUR_FILES = 3,       /* debuts ou destinations invalides */
+    TELEPORTEUR_ERREUR_MEMOIRE = 4,
+    TELEPORTEUR_ERREUR_INTERNE = 5      /* Toute autre exception du moteur */
+};
+
+/* Statistiques d'une simulation. attente, s'il n'est pas nul, doit avoir nb_files
+   cases : il reçoit l'attente moyenne de chaque file (0 pour une file vide). */
+typedef struct {
+    long long cycles;
+    long long deplacements;
+    double* attente;
+} teleporteur_resultats;
+
+/* Un cycle de la trace : sortie et entree valent 0 ou 1 */
+typedef void (*teleporteur_rappel_cycle)(void* contexte, long long cycle, long long depart, long long arrivee,
+                                         int sortie, int entree);
+
+/* Simule une politique sur des files en mémoire de l'appelant, lues sans copie :
+   les robots de la file i sont destinations[debuts[i]] .. destinations[debuts[i + 1] - 1],
+   debuts a nb_files + 1 cases croissantes à partir de 0. rappel peut être nul. */
+int teleporteur_simuler(int politique, int nb_files, const int* debuts, const int* destinations,
+                        teleporteur_rappel_cycle rappel, void* contexte, teleporteur_resultats* resultats);
+
+/* Message d'un code de retour, en anglais comme ceux du programme */
+const char* teleporteur_message(int code);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,94 @@
+#include "texte_entree.h"
+
+#include <algorithm>
+#include <cerrno>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace teleporteur
+{
+
+    static const size_t TAILLE_BLOC = 1 << 20;
+
+    TexteEntree::~TexteEntree()
+    {
+        liberer();
+    }
+
+    void TexteEntree::liberer()
+    {
+        if (projection != nullptr)
+        {
+            munmap(projection, taille);
+            projection = nullptr;
+        }
+        copie.clear();
+        texte = nullptr;
+        taille = 0;
+    }
+
+    bool TexteEntree::charger_fichier(const string &chemin)
+    {
+        int descripteur = open(chemin.c_str(), O_RDONLY);
+        if (descripteur < 0)
+        {
+            return false;
+        }
+        bool ok = charger_descripteur(descripteur);
+        close(descripteur);
+        return ok;
+    }
+
+    bool TexteEntree::charger_descripteur(int descripteur)
+    {
+        liberer();
+
+        struct stat infos;
+        if (fstat(descripteur, &infos) == 0 && S_ISREG(infos.st_mode) && infos.st_size > 0)
+        {
+            void *adresse = mmap(nullptr, infos.st_size, PROT_READ, MAP_PRIVATE, descripteur, 0);
+            if (adresse != MAP_FAILED)
+            {
+                madvise(adresse, infos.st_size, MADV_SEQUENTIAL);
+                projection = adresse;
+                texte = static_cast<const char *>(adresse);
+                taille = infos.st_size;
+                return true;
+            }
+        }
+
+        // Tube, terminal ou projection impossible : lecture par grands blocs
+        size_t lus = 0;
+        while (true)
+        {
+            if (copie.size() - lus < TAILLE_BLOC)
+            {
+                copie.resize(copie.size() + max(TAILLE_BLOC, copie.size()));
+            }
+            ssize_t n = read(descripteur, copie.data() + lus, copie.size() - lus);
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (n < 0)
+            {
+                liberer();
+                return false;
+            }
+            if (n == 0)
+            {
+                break;
+            }
+            lus += n;
+        }
+        texte = copie.data();
+        taille = lus;
+        return true;
+    }
+
+} // teleporteur
@@ -0,0 +1,36 @@
+#ifndef TEXTE_ENTREE_H
+#define TEXTE_ENTREE_H
+
+#include <string>
+#include <vector>
+
+namespace teleporteur {
+
+// **Texte d'entrée chargé en mémoire**
+// Un fichier régulier est projeté en mémoire (mmap) sans copie ; un tube ou un
+// terminal est lu par grands blocs. Le texte reste valide tant que l'objet vit.
+class TexteEntree
+{
+public:
+    TexteEntree() = default;
+    ~TexteEntree();
+    TexteEntree(const TexteEntree&) = delete;
+    TexteEntree& operator=(const TexteEntree&) = delete;
+
+    bool charger_fichier(const std::string& chemin);
+    bool charger_descripteur(int descripteur);
+    const char* debut() const { return texte; }
+    const char* fin() const { return texte + taille; }
+
+private:
+    void liberer();
+
+    const char* texte = nullptr;
+    std::size_t taille = 0;
+    void* projection = nullptr;        // Non nul si le texte est projeté
+    std::vector<char> copie;           // Texte lu par blocs sinon
+};
+
+} // teleporteur
+
+#endif
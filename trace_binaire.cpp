@@ -0,0 +1,388 @@
+#include "trace_binaire.h"
+#include "teleporteur.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+namespace teleporteur
+{
+
+    static const char MAGIE[8] = {'T', 'E', 'L', 'E', 'T', 'R', 'B', '1'};
+
+    struct PiedTrace
+    {
+        uint64_t nb_blocs;
+        int64_t nb_cycles;
+        int64_t dernier_cycle;
+        uint64_t decalage_index;
+        char magie[8];
+    };
+
+    const unsigned ABSOLU = 0;  // Arrivées codées par écart à la plus petite du bloc
+    const unsigned MOUVEMENT = 1; // Arrivées codées par écart au départ (mouvement), décalé du plus petit
+
+    static uint64_t zigzag(long long valeur)
+    {
+        return (static_cast<uint64_t>(valeur) << 1) ^ static_cast<uint64_t>(valeur >> 63);
+    }
+
+    static long long dezigzag(uint64_t valeur)
+    {
+        return static_cast<long long>(valeur >> 1) ^ -static_cast<long long>(valeur & 1);
+    }
+
+    static int largeur(uint64_t valeur)
+    {
+        return valeur == 0 ? 0 : 64 - __builtin_clzll(valeur);
+    }
+
+    static void coder(vector<unsigned char> &octets, uint64_t valeur)
+    {
+        while (valeur >= 0x80)
+        {
+            octets.push_back(static_cast<unsigned char>(valeur | 0x80));
+            valeur >>= 7;
+        }
+        octets.push_back(static_cast<unsigned char>(valeur));
+    }
+
+    static bool decoder(const unsigned char *&p, const unsigned char *fin, uint64_t &valeur)
+    {
+        valeur = 0;
+        for (int decalage = 0; decalage < 64 && p < fin; decalage += 7)
+        {
+            unsigned char octet = *p++;
+            valeur |= static_cast<uint64_t>(octet & 0x7F) << decalage;
+            if (octet < 0x80)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // **Bits à la suite, poids faibles d'abord**
+    struct EcrivainBits
+    {
+        vector<unsigned char> &octets;
+        uint64_t accumulateur = 0;
+        int nb = 0;
+
+        void ecrire(uint64_t valeur, int bits)
+        {
+            while (bits > 0)
+            {
+                int morceau = min(bits, 32);
+                accumulateur |= (valeur & ((uint64_t(1) << morceau) - 1)) << nb;
+                nb += morceau;
+                valeur = morceau == 64 ? 0 : valeur >> morceau;
+                bits -= morceau;
+                for (; nb >= 8; nb -= 8)
+                {
+                    octets.push_back(static_cast<unsigned char>(accumulateur));
+                    accumulateur >>= 8;
+                }
+            }
+        }
+        void terminer()
+        {
+            if (nb > 0)
+            {
+                octets.push_back(static_cast<unsigned char>(accumulateur));
+            }
+        }
+    };
+
+    struct LecteurBits
+    {
+        const unsigned char *p, *fin;
+        uint64_t accumulateur = 0;
+        int nb = 0;
+
+        bool lire(int bits, uint64_t &valeur)
+        {
+            valeur = 0;
+            for (int fait = 0; fait < bits;)
+            {
+                int morceau = min(bits - fait, 32);
+                for (; nb < morceau; nb += 8)
+                {
+                    if (p == fin)
+                    {
+                        return false;
+                    }
+                    accumulateur |= static_cast<uint64_t>(*p++) << nb;
+                }
+                valeur |= (accumulateur & ((uint64_t(1) << morceau) - 1)) << fait;
+                accumulateur >>= morceau;
+                nb -= morceau;
+                fait += morceau;
+            }
+            return true;
+        }
+    };
+
+    EcrivainTraceBinaire::EcrivainTraceBinaire(const string &chemin)
+        : fichier(fopen(chemin.c_str(), "wb")), detourne(nullptr, 64)
+    {
+        detourne.detourner_cycles(&EcrivainTraceBinaire::recevoir, this);
+        cycles.reserve(TAILLE_BLOC_TRACE);
+        bloc.reserve(3 * TAILLE_BLOC_TRACE);
+        echec = fichier == nullptr;
+        ecrire(MAGIE, sizeof(MAGIE));
+    }
+
+    EcrivainTraceBinaire::~EcrivainTraceBinaire()
+    {
+        terminer();
+    }
+
+    void EcrivainTraceBinaire::ecrire(const void *octets, size_t taille)
+    {
+        if (taille == 0) // Tampon vide : data() peut être nul
+        {
+            return;
+        }
+        if (!echec && fwrite(octets, 1, taille, fichier) != taille)
+        {
+            echec = true;
+        }
+        decalage += taille;
+    }
+
+    void EcrivainTraceBinaire::recevoir(void *contexte, long long cycle, long long depart, long long arrivee,
+                                        bool sortie, bool entree)
+    {
+        EcrivainTraceBinaire &ecrivain = *static_cast<EcrivainTraceBinaire *>(contexte);
+        if (ecrivain.cycles.size() == TAILLE_BLOC_TRACE)
+        {
+            ecrivain.fermer_bloc();
+        }
+        ecrivain.cycles.push_back(Cycle{cycle, depart, arrivee, (sortie ? 2u : 0u) | (entree ? 1u : 0u)});
+    }
+
+    // Exceptions (indice, écart de cycle, écart de départ), mode, largeur, base, puis les cycles en bits
+    void EcrivainTraceBinaire::fermer_bloc()
+    {
+        if (cycles.empty())
+        {
+            return;
+        }
+        index.push_back(EntreeIndexTrace{cycles[0].cycle, cycle_precedent, position_precedente, decalage,
+                                         static_cast<uint32_t>(cycles.size()), 0});
+        vector<size_t> exceptions;
+        long long cycle = cycle_precedent, position = position_precedente;
+        long long min_arrivee = cycles[0].arrivee, max_arrivee = min_arrivee;
+        long long min_mouvement = cycles[0].arrivee - cycles[0].depart, max_mouvement = min_mouvement;
+        for (size_t i = 0; i < cycles.size(); ++i)
+        {
+            const Cycle &c = cycles[i];
+            if (c.cycle != cycle + 1 || c.depart != position)
+            {
+                exceptions.push_back(i);
+            }
+            min_arrivee = min(min_arrivee, c.arrivee);
+            max_arrivee = max(max_arrivee, c.arrivee);
+            min_mouvement = min(min_mouvement, c.arrivee - c.depart);
+            max_mouvement = max(max_mouvement, c.arrivee - c.depart);
+            cycle = c.cycle;
+            position = c.arrivee;
+        }
+        int bits_absolus = largeur(static_cast<uint64_t>(max_arrivee) - static_cast<uint64_t>(min_arrivee));
+        int bits_mouvement = largeur(static_cast<uint64_t>(max_mouvement) - static_cast<uint64_t>(min_mouvement));
+        unsigned mode = bits_mouvement < bits_absolus ? MOUVEMENT : ABSOLU;
+        int bits = mode == ABSOLU ? bits_absolus : bits_mouvement;
+        long long base = mode == ABSOLU ? min_arrivee : min_mouvement;
+
+        coder(bloc, exceptions.size());
+        size_t precedente = 0;
+        for (size_t i : exceptions)
+        {
+            long long cycle_avant = i == 0 ? cycle_precedent : cycles[i - 1].cycle;
+            long long position_avant = i == 0 ? position_precedente : cycles[i - 1].arrivee;
+            coder(bloc, i - precedente);
+            coder(bloc, zigzag(cycles[i].cycle - cycle_avant - 1));
+            coder(bloc, zigzag(cycles[i].depart - position_avant));
+            precedente = i;
+        }
+        bloc.push_back(static_cast<unsigned char>(mode));
+        bloc.push_back(static_cast<unsigned char>(bits));
+        coder(bloc, zigzag(base));
+        EcrivainBits flux{bloc};
+        for (const Cycle &c : cycles)
+        {
+            if (c.actions == 3)
+            {
+                flux.ecrire(1, 1);
+            }
+            else
+            {
+                flux.ecrire(c.actions << 1, 3);
+            }
+            long long valeur = mode == ABSOLU ? c.arrivee : c.arrivee - c.depart;
+            flux.ecrire(static_cast<uint64_t>(valeur) - static_cast<uint64_t>(base), bits);
+        }
+        flux.terminer();
+
+        index.back().octets = static_cast<uint32_t>(bloc.size());
+        ecrire(bloc.data(), bloc.size());
+        bloc.clear();
+        cycle_precedent = cycles.back().cycle;
+        position_precedente = cycles.back().arrivee;
+        nb_cycles += cycles.size();
+        cycles.clear();
+    }
+
+    bool EcrivainTraceBinaire::terminer()
+    {
+        if (fichier == nullptr)
+        {
+            return !echec;
+        }
+        fermer_bloc();
+        PiedTrace pied;
+        memset(&pied, 0, sizeof(pied));
+        pied.nb_blocs = index.size();
+        pied.nb_cycles = nb_cycles;
+        pied.dernier_cycle = cycle_precedent;
+        pied.decalage_index = decalage;
+        memcpy(pied.magie, MAGIE, sizeof(MAGIE));
+        ecrire(index.data(), index.size() * sizeof(EntreeIndexTrace));
+        ecrire(&pied, sizeof(pied));
+        echec = (fclose(fichier) != 0) || echec;
+        fichier = nullptr;
+        return !echec;
+    }
+
+    bool LecteurTraceBinaire::ouvrir(const string &chemin)
+    {
+        index.clear();
+        total = 0;
+        if (!fichier.charger_fichier(chemin))
+        {
+            return false;
+        }
+        size_t taille = fichier.fin() - fichier.debut();
+        PiedTrace pied;
+        if (taille < sizeof(MAGIE) + sizeof(pied) || memcmp(fichier.debut(), MAGIE, sizeof(MAGIE)) != 0)
+        {
+            return false;
+        }
+        memcpy(&pied, fichier.fin() - sizeof(pied), sizeof(pied));
+        uint64_t fin_index = taille - sizeof(pied);
+        if (memcmp(pied.magie, MAGIE, sizeof(MAGIE)) != 0 || pied.decalage_index > fin_index ||
+            (fin_index - pied.decalage_index) / sizeof(EntreeIndexTrace) != pied.nb_blocs ||
+            (fin_index - pied.decalage_index) % sizeof(EntreeIndexTrace) != 0)
+        {
+            return false;
+        }
+        index.resize(pied.nb_blocs);
+        if (pied.nb_blocs > 0) // Trace sans cycle : index vide, data() peut être nul
+        {
+            memcpy(index.data(), fichier.debut() + pied.decalage_index, pied.nb_blocs * sizeof(EntreeIndexTrace));
+        }
+        for (const EntreeIndexTrace &entree : index)
+        {
+            if (entree.decalage > pied.decalage_index || entree.octets > pied.decalage_index - entree.decalage)
+            {
+                index.clear();
+                return false;
+            }
+            total += entree.nb_cycles;
+        }
+        if (total != pied.nb_cycles)
+        {
+            index.clear();
+            total = 0;
+            return false;
+        }
+        dernier = pied.dernier_cycle;
+        return true;
+    }
+
+    long long LecteurTraceBinaire::premier_cycle() const
+    {
+        return index.empty() ? 0 : index.front().premier_cycle;
+    }
+
+    bool LecteurTraceBinaire::rejouer(long long premier, long long dernier_demande, TamponSortie &sortie) const
+    {
+        // Dernier bloc qui commence au plus tard au premier cycle demandé
+        auto bloc = upper_bound(index.begin(), index.end(), premier,
+                                [](long long cycle, const EntreeIndexTrace &entree)
+                                { return cycle < entree.premier_cycle; });
+        if (bloc != index.begin())
+        {
+            --bloc;
+        }
+        for (; bloc != index.end() && bloc->premier_cycle <= dernier_demande; ++bloc)
+        {
+            const unsigned char *p = reinterpret_cast<const unsigned char *>(fichier.debut()) + bloc->decalage;
+            const unsigned char *fin = p + bloc->octets;
+            uint64_t nb_exceptions;
+            if (!decoder(p, fin, nb_exceptions) || nb_exceptions > bloc->nb_cycles)
+            {
+                return false;
+            }
+            vector<uint64_t> exceptions(3 * nb_exceptions);
+            for (uint64_t &valeur : exceptions)
+            {
+                if (!decoder(p, fin, valeur))
+                {
+                    return false;
+                }
+            }
+            uint64_t base;
+            if (fin - p < 2 || p[0] > MOUVEMENT || p[1] > 64)
+            {
+                return false;
+            }
+            unsigned mode = p[0];
+            int bits = p[1];
+            p += 2;
+            if (!decoder(p, fin, base))
+            {
+                return false;
+            }
+            LecteurBits flux{p, fin};
+            long long cycle = bloc->cycle_precedent;
+            long long position = bloc->position_precedente;
+            size_t prochaine = 0;
+            uint64_t indice_exception = nb_exceptions > 0 ? exceptions[0] : 0;
+            for (uint32_t n = 0; n < bloc->nb_cycles; ++n)
+            {
+                ++cycle;
+                if (prochaine < nb_exceptions && n == indice_exception)
+                {
+                    cycle += dezigzag(exceptions[3 * prochaine + 1]);
+                    position += dezigzag(exceptions[3 * prochaine + 2]);
+                    if (++prochaine < nb_exceptions)
+                    {
+                        indice_exception += exceptions[3 * prochaine];
+                    }
+                }
+                uint64_t courant, actions = 3, valeur;
+                if (!flux.lire(1, courant) || (courant == 0 && !flux.lire(2, actions)) ||
+                    !flux.lire(bits, valeur))
+                {
+                    return false;
+                }
+                long long depart = position;
+                valeur += static_cast<uint64_t>(dezigzag(base));
+                position = mode == ABSOLU ? static_cast<long long>(valeur) : depart + static_cast<long long>(valeur);
+                if (cycle > dernier_demande)
+                {
+                    return true;
+                }
+                if (cycle >= premier)
+                {
+                    afficher_cycle(&sortie, cycle, depart, position, (actions & 2) != 0, (actions & 1) != 0);
+                }
+            }
+        }
+        return true;
+    }
+
+} // teleporteur
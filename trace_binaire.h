@@ -0,0 +1,98 @@
+#ifndef TRACE_BINAIRE_H
+#define TRACE_BINAIRE_H
+
+#include "tampon_sortie.h"
+#include "texte_entree.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace teleporteur {
+
+// **Trace binaire**
+// Remplace le texte SHOW_CYCLES d'une politique, par blocs de TAILLE_BLOC_TRACE
+// cycles. Dans un bloc, chaque cycle ne garde que ses actions (un bit pour
+// « 1 1 », le cas courant, trois sinon) et son arrivée sur un nombre fixe de
+// bits : écart à la plus petite arrivée du bloc, ou écart à l'arrivée précédente
+// si c'est plus court. Le départ est l'arrivée précédente et le cycle suit le
+// précédent, sauf pour quelques exceptions listées en tête du bloc (flux). Chaque
+// bloc commence par l'état dont son décodage a besoin (cycle et position du
+// scanner avant son premier cycle), recopié dans un index à la fin du fichier :
+// un cycle se retrouve par recherche dans l'index puis décodage d'un seul bloc,
+// quelle que soit la longueur de la trace.
+// Fichier : 8 octets d'identification, les blocs, l'index (un EntreeIndexTrace
+// par bloc) puis un pied de taille fixe. Tout est écrit à la suite : le fichier
+// peut être un tube.
+const int TAILLE_BLOC_TRACE = 1 << 14;            // Cycles par bloc
+
+struct EntreeIndexTrace {
+    std::int64_t premier_cycle;
+    std::int64_t cycle_precedent;                 // État avant le bloc
+    std::int64_t position_precedente;
+    std::uint64_t decalage;                       // Début du bloc dans le fichier
+    std::uint32_t nb_cycles;
+    std::uint32_t octets;
+};
+
+// **Écriture d'une trace binaire**
+// tampon() se passe aux moteurs comme trace : ses cycles sont détournés (voir
+// TamponSortie::detourner_cycles()) vers le codage binaire.
+class EcrivainTraceBinaire
+{
+public:
+    explicit EcrivainTraceBinaire(const std::string& chemin);
+    ~EcrivainTraceBinaire();                       // terminer()
+    EcrivainTraceBinaire(const EcrivainTraceBinaire&) = delete;
+    EcrivainTraceBinaire& operator=(const EcrivainTraceBinaire&) = delete;
+
+    TamponSortie* tampon() { return &detourne; }
+    bool terminer();                               // Dernier bloc, index et pied ; faux si une écriture a échoué
+
+private:
+    struct Cycle {
+        long long cycle, depart, arrivee;
+        unsigned actions;                          // sortie * 2 + entree
+    };
+
+    static void recevoir(void* contexte, long long cycle, long long depart, long long arrivee, bool sortie,
+                         bool entree);
+    void fermer_bloc();
+    void ecrire(const void* octets, std::size_t taille);
+
+    std::FILE* fichier;
+    bool echec = false;
+    TamponSortie detourne;
+    std::vector<Cycle> cycles;                     // Bloc en cours
+    std::vector<unsigned char> bloc;               // Bloc codé
+    std::vector<EntreeIndexTrace> index;
+    std::uint64_t decalage = 0;                    // Octets déjà écrits
+    long long cycle_precedent = 0;
+    long long position_precedente = 0;
+    long long nb_cycles = 0;
+};
+
+// **Lecture d'une trace binaire**
+// Le fichier est projeté en mémoire ; seuls les blocs demandés sont décodés.
+class LecteurTraceBinaire
+{
+public:
+    bool ouvrir(const std::string& chemin);        // Faux si absent ou invalide
+    long long nb_cycles() const { return total; }
+    long long premier_cycle() const;               // 0 si la trace est vide
+    long long dernier_cycle() const { return dernier; }
+    // Redonne les cycles de premier à dernier_demande (inclus) par afficher_cycle() :
+    // exactement les lignes du texte SHOW_CYCLES. Faux si un bloc est corrompu.
+    bool rejouer(long long premier, long long dernier_demande, TamponSortie& sortie) const;
+
+private:
+    TexteEntree fichier;
+    std::vector<EntreeIndexTrace> index;
+    long long total = 0;
+    long long dernier = 0;
+};
+
+} // teleporteur
+
+#endif
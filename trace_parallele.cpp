@@ -0,0 +1,57 @@
+#include "trace_parallele.h"
+#include "teleporteur.h"
+
+using namespace std;
+
+namespace teleporteur
+{
+
+    TraceParallele::TraceParallele(TamponSortie &sortie, bool vider_en_attente, size_t capacite)
+        : sortie(sortie), vider_en_attente(vider_en_attente), detourne(nullptr, 64), anneau(capacite)
+    {
+        detourne.detourner_cycles(&TraceParallele::recevoir, this);
+        fil = thread(&TraceParallele::boucle, this);
+    }
+
+    TraceParallele::~TraceParallele()
+    {
+        terminer();
+    }
+
+    void TraceParallele::terminer()
+    {
+        if (fil.joinable())
+        {
+            anneau.fermer();
+            fil.join();
+        }
+    }
+
+    void TraceParallele::recevoir(void *contexte, long long, long long depart, long long arrivee, bool sortie,
+                                  bool entree)
+    {
+        static_cast<TraceParallele *>(contexte)->anneau.pousser(EnregistrementCycle{depart, arrivee, sortie, entree});
+    }
+
+    void TraceParallele::boucle()
+    {
+        EnregistrementCycle lot[256];
+        while (true)
+        {
+            if (vider_en_attente && !anneau.pret())
+            {
+                sortie.vider();
+            }
+            size_t nb = anneau.retirer(lot, 256);
+            if (nb == 0)
+            {
+                break;
+            }
+            for (size_t i = 0; i < nb; ++i)
+            {
+                afficher_cycle(&sortie, 0, lot[i].depart, lot[i].arrivee, lot[i].sortie, lot[i].entree);
+            }
+        }
+    }
+
+} // teleporteur
@@ -0,0 +1,53 @@
+#ifndef TRACE_PARALLELE_H
+#define TRACE_PARALLELE_H
+
+#include "anneau_spsc.h"
+#include "tampon_sortie.h"
+
+#include <thread>
+
+namespace teleporteur {
+
+// **Cycle de trace à formater**
+// Le numéro de cycle n'est pas dans le texte SHOW_CYCLES : il n'est pas transmis.
+struct EnregistrementCycle {
+    long long depart;
+    long long arrivee;
+    bool sortie;
+    bool entree;
+};
+
+// **Trace formatée sur un fil à part**
+// tampon() se passe aux moteurs comme trace : ses cycles sont détournés (voir
+// TamponSortie::detourner_cycles()) vers un anneau, et un autre fil les écrit
+// dans sortie, avec exactement le texte de afficher_cycle(). Le moteur ne fait
+// jamais d'entrée-sortie ; il n'attend que si l'anneau est plein. Personne
+// d'autre ne doit écrire dans sortie avant terminer().
+// vider_en_attente : sortie est vidée chaque fois que l'anneau est vide, pour
+// que la trace d'un flux sorte au fur et à mesure.
+class TraceParallele
+{
+public:
+    explicit TraceParallele(TamponSortie& sortie, bool vider_en_attente = false, std::size_t capacite = 1 << 14);
+    ~TraceParallele();                             // terminer()
+    TraceParallele(const TraceParallele&) = delete;
+    TraceParallele& operator=(const TraceParallele&) = delete;
+
+    TamponSortie* tampon() { return &detourne; }
+    void terminer();                               // Attend que tous les cycles reçus soient écrits
+
+private:
+    static void recevoir(void* contexte, long long cycle, long long depart, long long arrivee, bool sortie,
+                         bool entree);
+    void boucle();
+
+    TamponSortie& sortie;
+    bool vider_en_attente;
+    TamponSortie detourne;
+    AnneauSpsc<EnregistrementCycle> anneau;
+    std::thread fil;
+};
+
+} // teleporteur
+
+#endif
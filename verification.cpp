@@ -0,0 +1,695 @@
+#include "teleporteur.h"
+#include "tampon_sortie.h"
+#include "generateur.h"
+#include "iterateur_cycles.h"
+#include "bibliotheque.h"
+#include "flux_arrivees.h"
+#include "multi_scanners.h"
+#include "trace_parallele.h"
+#include "trace_binaire.h"
+#include "point_reprise.h"
+#include "lot.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace teleporteur;
+
+// **Vérification différentielle des moteurs**
+// Tire des scénarios au hasard (dont les cas limites : une seule file, robots qui
+// sortent par leur propre file, files vides, aucun robot) et compare, dans le même
+// processus, une simulation de référence écrite au plus simple (tableaux et
+// parcours linéaires, rien de partagé avec les moteurs) à tous les chemins
+// optimisés : moteur avec trace, moteur rapide sans trace, itérateur de cycles,
+// bibliothèque, mode creux, scanner unique, flux (lu sur place ou en parallèle),
+// trace formatée sur un autre fil, trace binaire relue, points de reprise (dont
+// leur cadence) et le mode lot sur plusieurs fils. Traces complètes et
+// statistiques doivent être identiques. Une
+// différence est réduite au plus petit scénario qui la montre encore, écrit au
+// format de l'entrée standard ; le code de retour vaut alors 1.
+
+struct Scenario {
+	std::vector<std::vector<int>> files;   // Sorties des robots de chaque file, dans l'ordre
+};
+
+static long long nb_comparaisons = 0;
+
+static std::string texte_scenario(const Scenario& scenario, const char* affichage) {
+	std::string texte = std::string(affichage) + "\n" + std::to_string(scenario.files.size()) + "\n";
+	for (size_t file = 0; file < scenario.files.size(); ++file) {
+		for (int destination : scenario.files[file]) {
+			texte += std::to_string(file) + " " + std::to_string(destination) + "\n";
+		}
+	}
+	return texte + "-1 -1\n";
+}
+
+// Passe par le texte, comme le programme : la lecture est vérifiée au passage
+static bool lire_scenario(const Scenario& scenario, bool creux, Parametres& param) {
+	std::string texte = texte_scenario(scenario, "SHOW_CYCLES");
+	bool error_trouve = false;
+	analyser_parametres(texte.data(), texte.data() + texte.size(), param, error_trouve, creux);
+	return verifier_parametres(param, error_trouve).empty();
+}
+
+// **Simulation de référence**
+// L'énoncé tel quel : à chaque cycle, charger si la file du scanner a un robot
+// (et, pour FANEQLI, n'a pas encore été servie dans ce tour), sinon partir vers
+// la file choisie par la politique en cherchant linéairement.
+struct Reference {
+	std::vector<CycleSimule> trace;
+	Resultats resultats;
+};
+
+static Reference simuler_reference(const Scenario& scenario, TypePolitique politique) {
+	int nb_files = static_cast<int>(scenario.files.size());
+	std::vector<size_t> tete(nb_files, 0);
+	std::vector<char> servie(nb_files, 0);
+	std::vector<long long> somme(nb_files, 0);
+	auto vide = [&](int file) { return tete[file] == scenario.files[file].size(); };
+	auto non_vide_vers = [&](int depuis, int pas) {
+		for (int file = depuis; file >= 0 && file < nb_files; file += pas) {
+			if (!vide(file)) {
+				return file;
+			}
+		}
+		return -1;
+	};
+	Reference reference;
+	long long cycle = 0, deplacements = 0;
+	int scanner = 0, robot = -1;
+	bool montee = true;
+	while (non_vide_vers(0, 1) != -1 || robot != -1) {
+		if (politique == TypePolitique::faneqli) {
+			// Nouveau tour quand toutes les files non vides ont été servies
+			bool eligible = false, servie_non_vide = false;
+			for (int file = 0; file < nb_files; ++file) {
+				if (!vide(file)) {
+					(servie[file] ? servie_non_vide : eligible) = true;
+				}
+			}
+			if (!eligible && servie_non_vide) {
+				std::fill(servie.begin(), servie.end(), 0);
+			}
+		}
+		CycleSimule c;
+		c.cycle = ++cycle;
+		c.sortie = robot != -1;
+		c.depart = scanner;
+		int depart = scanner;
+		c.entree = !vide(depart) && !(politique == TypePolitique::faneqli && servie[depart]);
+		if (c.entree) {
+			robot = scenario.files[depart][tete[depart]++];
+			servie[depart] = 1;
+			somme[depart] += cycle;
+			scanner = robot;
+		} else {
+			robot = -1;
+			int prochaine = -1;
+			switch (politique) {
+			case TypePolitique::neqli:
+				prochaine = non_vide_vers(0, 1);
+				break;
+			case TypePolitique::faneqli:
+				for (int file = 0; file < nb_files && prochaine == -1; ++file) {
+					prochaine = !vide(file) && !servie[file] ? file : -1;
+				}
+				break;
+			case TypePolitique::sstf:
+				for (int d = 1; d < nb_files && prochaine == -1; ++d) {
+					if (depart - d >= 0 && !vide(depart - d)) {
+						prochaine = depart - d;
+					} else if (depart + d < nb_files && !vide(depart + d)) {
+						prochaine = depart + d;
+					}
+				}
+				break;
+			case TypePolitique::scan:
+				prochaine = non_vide_vers(depart, montee ? 1 : -1);
+				if (prochaine == -1) {
+					montee = !montee;
+					prochaine = non_vide_vers(depart, montee ? 1 : -1);
+				}
+				break;
+			}
+			if (prochaine != -1) {
+				scanner = prochaine;
+			}
+		}
+		c.arrivee = scanner;
+		c.distance = std::abs(scanner - depart);
+		deplacements += c.distance;
+		reference.trace.push_back(c);
+	}
+	reference.resultats.cycles = cycle;
+	reference.resultats.deplacements = deplacements;
+	reference.resultats.attente.resize(nb_files);
+	for (int file = 0; file < nb_files; ++file) {
+		size_t nb = scenario.files[file].size();
+		reference.resultats.attente[file] = nb > 0 ? static_cast<double>(somme[file]) / nb : 0.0;
+	}
+	return reference;
+}
+
+// Texte SHOW_CYCLES formaté sans TamponSortie
+static std::string texte_trace(const std::vector<CycleSimule>& trace) {
+	std::string texte;
+	char ligne[64];
+	for (const CycleSimule& c : trace) {
+		std::snprintf(ligne, sizeof(ligne), "%lld\t%lld\t%d %d\n", c.depart, c.arrivee, c.sortie ? 1 : 0,
+		              c.entree ? 1 : 0);
+		texte += ligne;
+	}
+	return texte;
+}
+
+// **Comparaisons** : message vide si identiques
+static std::string comparer_textes(const char* chemin, const std::string& attendu, const std::string& obtenu) {
+	++nb_comparaisons;
+	if (attendu == obtenu) {
+		return "";
+	}
+	size_t i = 0;
+	long long ligne = 1;
+	for (; i < attendu.size() && i < obtenu.size() && attendu[i] == obtenu[i]; ++i) {
+		ligne += attendu[i] == '\n';
+	}
+	return std::string(chemin) + " : trace différente à la ligne " + std::to_string(ligne);
+}
+
+static std::string comparer_resultats(const char* chemin, const Resultats& attendu, const Resultats& obtenu) {
+	++nb_comparaisons;
+	if (attendu.cycles != obtenu.cycles) {
+		return std::string(chemin) + " : " + std::to_string(obtenu.cycles) + " cycles au lieu de " +
+		       std::to_string(attendu.cycles);
+	}
+	if (attendu.deplacements != obtenu.deplacements) {
+		return std::string(chemin) + " : " + std::to_string(obtenu.deplacements) + " déplacements au lieu de " +
+		       std::to_string(attendu.deplacements);
+	}
+	if (attendu.attente != obtenu.attente) {
+		return std::string(chemin) + " : attentes moyennes différentes";
+	}
+	return "";
+}
+
+static std::string comparer_cycles(const char* chemin, const std::vector<CycleSimule>& attendu,
+                                   const std::vector<CycleSimule>& obtenu) {
+	++nb_comparaisons;
+	for (size_t i = 0; i < attendu.size() && i < obtenu.size(); ++i) {
+		const CycleSimule& a = attendu[i];
+		const CycleSimule& o = obtenu[i];
+		if (a.cycle != o.cycle || a.depart != o.depart || a.arrivee != o.arrivee || a.distance != o.distance ||
+		    a.sortie != o.sortie || a.entree != o.entree) {
+			return std::string(chemin) + " : cycle " + std::to_string(a.cycle) + " différent";
+		}
+	}
+	if (attendu.size() != obtenu.size()) {
+		return std::string(chemin) + " : " + std::to_string(obtenu.size()) + " cycles au lieu de " +
+		       std::to_string(attendu.size());
+	}
+	return "";
+}
+
+static void recevoir_cycle(void* contexte, long long cycle, long long depart, long long arrivee, bool sortie,
+                           bool entree) {
+	static_cast<std::vector<CycleSimule>*>(contexte)->push_back(
+		CycleSimule{cycle, depart, arrivee, depart > arrivee ? depart - arrivee : arrivee - depart, sortie, entree});
+}
+
+// Flux équivalent au scénario : tous les robots arrivent au cycle 0
+static std::string comparer_flux(const Scenario& scenario, TypePolitique politique, bool en_parallele,
+                                 const std::string& trace_attendue, const Resultats& attendu) {
+	const char* chemin = en_parallele ? "flux lu en parallèle" : "flux";
+	std::string texte = "SHOW_CYCLES\n" + std::to_string(scenario.files.size()) + "\n";
+	for (size_t file = 0; file < scenario.files.size(); ++file) {
+		for (int destination : scenario.files[file]) {
+			texte += "0 " + std::to_string(file) + " " + std::to_string(destination) + "\n";
+		}
+	}
+	texte += "-1 -1 -1\n";
+	std::FILE* fichier = std::tmpfile();
+	if (fichier == nullptr || std::fwrite(texte.data(), 1, texte.size(), fichier) != texte.size() ||
+	    std::fflush(fichier) != 0 || lseek(fileno(fichier), 0, SEEK_SET) != 0) {
+		return std::string(chemin) + " : fichier temporaire impossible";
+	}
+	Parametres param;
+	TamponSortie trace(nullptr);
+	Resultats resultats;
+	bool ok;
+	{
+		FluxArrivees flux(fileno(fichier), nullptr, 64); // Petit tampon : les jetons coupés sont vérifiés aussi
+		ok = flux.lire_entete(param);
+		if (ok && en_parallele) {
+			flux.lire_en_parallele(16);
+		}
+		ok = ok && simuler_flux(politique, param, flux, &trace, resultats);
+	}
+	std::fclose(fichier);
+	if (!ok) {
+		return std::string(chemin) + " : flux refusé";
+	}
+	std::string ecart = comparer_textes(chemin, trace_attendue, trace.texte());
+	return ecart.empty() ? comparer_resultats(chemin, attendu, resultats) : ecart;
+}
+
+// **Tous les chemins d'une politique sur un scénario**
+static std::string verifier(const Scenario& scenario, TypePolitique politique, const std::string& dossier) {
+	Reference reference = simuler_reference(scenario, politique);
+	std::string trace_attendue = texte_trace(reference.trace);
+	const Resultats& attendu = reference.resultats;
+	Parametres param;
+	if (!lire_scenario(scenario, false, param)) {
+		return "lecture : scénario refusé";
+	}
+	std::string ecart;
+	auto verifier_trace = [&](const char* chemin, const TamponSortie& trace, const Resultats& resultats) {
+		ecart = comparer_textes(chemin, trace_attendue, trace.texte());
+		if (ecart.empty()) {
+			ecart = comparer_resultats(chemin, attendu, resultats);
+		}
+		return ecart.empty();
+	};
+
+	TamponSortie trace(nullptr);
+	Resultats resultats = simuler_politique(politique, param, &trace);
+	if (!verifier_trace("moteur avec trace", trace, resultats)) {
+		return ecart;
+	}
+	if (!(ecart = comparer_resultats("moteur sans trace", attendu, simuler_politique(politique, param, nullptr)))
+	         .empty()) {
+		return ecart;
+	}
+
+	// Itérateur : tous les cycles, puis arrêt à mi-chemin et statistiques directes
+	{
+		IterateurCycles iterateur(politique, param);
+		std::vector<CycleSimule> cycles;
+		CycleSimule cycle;
+		while (iterateur.suivant(cycle)) {
+			cycles.push_back(cycle);
+		}
+		if (!(ecart = comparer_cycles("itérateur", reference.trace, cycles)).empty() ||
+		    !(ecart = comparer_resultats("itérateur", attendu, iterateur.resultats())).empty()) {
+			return ecart;
+		}
+		IterateurCycles interrompu(politique, param);
+		for (size_t n = 0; n < reference.trace.size() / 2 && interrompu.suivant(cycle); ++n) {
+		}
+		if (!(ecart = comparer_resultats("itérateur interrompu", attendu, interrompu.resultats())).empty()) {
+			return ecart;
+		}
+	}
+
+	// Bibliothèque : files empruntées et rappel par cycle
+	{
+		Parametres emprunte;
+		std::vector<int> debuts(param.debuts.begin(), param.debuts.end());
+		std::vector<int> destinations(param.destinations.begin(), param.destinations.end());
+		destinations.push_back(0); // data() jamais nul
+		if (!emprunter_files(param.nb_files, debuts.data(), destinations.data(), emprunte).empty()) {
+			return "bibliothèque : files refusées";
+		}
+		std::vector<CycleSimule> cycles;
+		resultats = simuler_avec_rappel(politique, emprunte, recevoir_cycle, &cycles);
+		if (!(ecart = comparer_cycles("bibliothèque", reference.trace, cycles)).empty() ||
+		    !(ecart = comparer_resultats("bibliothèque", attendu, resultats)).empty()) {
+			return ecart;
+		}
+	}
+
+	// Trace formatée sur un autre fil
+	{
+		TamponSortie texte(nullptr);
+		{
+			TraceParallele parallele(texte);
+			resultats = simuler_politique(politique, param, parallele.tampon());
+		}
+		if (!verifier_trace("trace en parallèle", texte, resultats)) {
+			return ecart;
+		}
+	}
+
+	// Trace binaire écrite puis relue
+	{
+		std::string chemin = dossier + "/trace";
+		{
+			EcrivainTraceBinaire binaire(chemin);
+			resultats = simuler_politique(politique, param, binaire.tampon());
+			if (!binaire.terminer()) {
+				return "trace binaire : écriture impossible";
+			}
+		}
+		LecteurTraceBinaire lecteur;
+		TamponSortie texte(nullptr);
+		if (!lecteur.ouvrir(chemin) || !lecteur.rejouer(lecteur.premier_cycle(), lecteur.dernier_cycle(), texte)) {
+			return "trace binaire : relecture impossible";
+		}
+		if (!verifier_trace("trace binaire", texte, resultats)) {
+			return ecart;
+		}
+	}
+
+	// Points de reprise : mêmes statistiques, et un état publié au moins tous les
+	// intervalle cycles, à une suite de robots pour leur propre file près (le moteur
+	// rapide de NEQLI la compte d'un bloc)
+	{
+		long long intervalle = 1 + attendu.cycles / 10;
+		long long suite = 0;
+		for (size_t file = 0; file < scenario.files.size(); ++file) {
+			long long n = 0;
+			for (int destination : scenario.files[file]) {
+				n = destination == static_cast<int>(file) ? n + 1 : 0;
+				suite = std::max(suite, n);
+			}
+		}
+		long long minimum = attendu.cycles > 1 ? (attendu.cycles - 1) / (intervalle + suite + 1) : 0;
+		for (TamponSortie* trace_reprise : {static_cast<TamponSortie*>(nullptr), &trace}) {
+			trace.effacer();
+			long long periodiques;
+			{
+				EcrivainPointsReprise ecrivain(dossier + "/reprise", intervalle);
+				Reprise reprise;
+				reprise.ecrivain = &ecrivain;
+				reprise.empreinte = empreinte_parametres(param);
+				resultats = simuler_politique(politique, param, trace_reprise, nullptr, Quantiles::aucun, &reprise);
+				periodiques = ecrivain.nb_publies() - 1; // Le dernier est l'état final
+			}
+			const char* chemin = trace_reprise == nullptr ? "points de reprise sans trace" : "points de reprise";
+			if (!(ecart = comparer_resultats(chemin, attendu, resultats)).empty()) {
+				return ecart;
+			}
+			if (periodiques < minimum) {
+				return std::string(chemin) + " : " + std::to_string(periodiques) + " états publiés en " +
+				       std::to_string(attendu.cycles) + " cycles, au moins " + std::to_string(minimum) +
+				       " attendus (intervalle " + std::to_string(intervalle) + ")";
+			}
+		}
+	}
+
+	// Mode creux : mêmes numéros de file, attentes rangées par file gardée
+	{
+		Parametres creux;
+		if (!lire_scenario(scenario, true, creux)) {
+			return "mode creux : scénario refusé";
+		}
+		for (TamponSortie* trace_creux : {static_cast<TamponSortie*>(nullptr), &trace}) {
+			trace.effacer();
+			Resultats compacts = simuler_politique(politique, creux, trace_creux);
+			resultats = compacts;
+			resultats.attente.assign(scenario.files.size(), 0.0);
+			for (int i = 0; i < creux.nb_files; ++i) {
+				resultats.attente[creux.numero(i)] = compacts.attente[i];
+			}
+			if (trace_creux == nullptr) {
+				ecart = comparer_resultats("mode creux sans trace", attendu, resultats);
+			} else {
+				verifier_trace("mode creux", trace, resultats);
+			}
+			if (!ecart.empty()) {
+				return ecart;
+			}
+		}
+	}
+
+	if (politique_multi_scanners(politique)) {
+		ResultatsScanners scanners;
+		simuler_scanners(politique, param, 1, scanners);
+		if (!(ecart = comparer_resultats("un seul scanner", attendu, scanners.total)).empty()) {
+			return ecart;
+		}
+	}
+
+	for (bool en_parallele : {false, true}) {
+		if (!(ecart = comparer_flux(scenario, politique, en_parallele, trace_attendue, attendu)).empty()) {
+			return ecart;
+		}
+	}
+	return "";
+}
+
+// **Mode lot** : une ligne par scénario, calculée sur plusieurs fils
+static std::string verifier_lot(const std::vector<Scenario>& scenarios, const std::string& dossier,
+                                size_t* fautif = nullptr) {
+	std::vector<std::string> chemins;
+	TamponSortie attendu(nullptr);
+	for (size_t i = 0; i < scenarios.size(); ++i) {
+		chemins.push_back(dossier + "/lot" + std::to_string(i) + ".txt");
+		std::FILE* fichier = std::fopen(chemins.back().c_str(), "w");
+		std::string texte = texte_scenario(scenarios[i], "SHOW_NO_CYCLE");
+		if (fichier == nullptr || std::fwrite(texte.data(), 1, texte.size(), fichier) != texte.size()) {
+			if (fichier != nullptr) {
+				std::fclose(fichier);
+			}
+			return "lot : fichier temporaire impossible";
+		}
+		std::fclose(fichier);
+		afficher_statistiques_ligne(chemins.back(), simuler_reference(scenarios[i], TypePolitique::neqli).resultats,
+		                            simuler_reference(scenarios[i], TypePolitique::faneqli).resultats, attendu);
+	}
+	TamponSortie obtenu(nullptr);
+	executer_lot(chemins, FormatLot::texte, 4, obtenu);
+	for (const std::string& chemin : chemins) {
+		std::remove(chemin.c_str());
+	}
+	std::string ecart = comparer_textes("lot", attendu.texte(), obtenu.texte());
+	if (!ecart.empty() && fautif != nullptr) {
+		// Première ligne différente : le scénario fautif
+		std::string a = attendu.texte(), o = obtenu.texte();
+		size_t i = 0;
+		*fautif = 0;
+		for (; i < a.size() && i < o.size() && a[i] == o[i]; ++i) {
+			*fautif += a[i] == '\n';
+		}
+	}
+	return ecart.empty() ? "" : "lot : ligne différente";
+}
+
+// **Tirage d'un scénario**
+// Les tailles restent petites la plupart du temps : les différences se trouvent
+// vite et se réduisent vite. Un essai sur cinquante est plus gros.
+static Scenario tirer_scenario(std::mt19937_64& aleatoire, int essai) {
+	static const int TAILLES[] = {1, 1, 2, 2, 3, 4, 5, 8, 13, 32, 64, 65, 100};
+	auto tirer = [&](int n) { return static_cast<int>(aleatoire() % static_cast<unsigned>(n)); };
+	bool gros = essai % 50 == 49;
+	int nb_files = gros ? 500 + tirer(2000) : TAILLES[tirer(sizeof(TAILLES) / sizeof(TAILLES[0]))];
+	int nb_robots = gros ? tirer(20000) : tirer(4 * nb_files + 12);
+	Scenario scenario;
+	scenario.files.resize(nb_files);
+	int genre = tirer(8);
+	if (genre == 6) {
+		// Charges du générateur (zipf, ping_pong...)
+		DescriptionCharge charge;
+		charge.type = static_cast<TypeCharge>(tirer(5));
+		charge.nb_files = nb_files;
+		charge.nb_robots = nb_robots;
+		charge.graine = aleatoire();
+		Parametres param;
+		generer_parametres(charge, param);
+		for (int file = 0; file < nb_files; ++file) {
+			for (int r = param.debuts[file]; r < param.debuts[file + 1]; ++r) {
+				scenario.files[file].push_back(param.destinations[r]);
+			}
+		}
+		return scenario;
+	}
+	int occupees = genre == 3 ? 1 + tirer(3) : nb_files; // 3 : presque toutes les files vides
+	std::vector<int> files_occupees(occupees);
+	for (int i = 0; i < occupees; ++i) {
+		files_occupees[i] = genre == 3 ? tirer(nb_files) : i;
+	}
+	nb_robots = genre == 5 ? 0 : nb_robots;      // 5 : aucun robot
+	for (int r = 0; r < nb_robots; ++r) {
+		int file = files_occupees[tirer(occupees)];
+		int destination;
+		switch (genre) {
+		case 1: // Chaque robot sort par sa propre file
+			destination = file;
+			break;
+		case 2:
+			destination = 0;
+			break;
+		case 7: // Aller-retour d'un bout à l'autre
+			destination = nb_files - 1 - file;
+			break;
+		default:
+			destination = tirer(nb_files);
+			break;
+		}
+		scenario.files[file].push_back(destination);
+	}
+	return scenario;
+}
+
+// **Réduction d'un scénario fautif**
+// Retire des tranches de files puis de robots, de la moitié jusqu'à un seul
+// élément, puis ramène les sorties à 0 ou à la file du robot quand c'est plus
+// petit, tant que la différence reste visible.
+static Scenario sans_files(const Scenario& scenario, size_t premiere, size_t nb) {
+	Scenario essai;
+	int debut = static_cast<int>(premiere), fin = static_cast<int>(premiere + nb);
+	for (size_t file = 0; file < scenario.files.size(); ++file) {
+		if (file >= premiere && file < premiere + nb) {
+			continue;
+		}
+		essai.files.push_back(scenario.files[file]);
+		for (int& destination : essai.files.back()) {
+			bool retiree = destination >= debut && destination < fin;
+			destination = retiree ? 0 : destination - (destination >= fin ? static_cast<int>(nb) : 0);
+		}
+	}
+	return essai;
+}
+
+// Robots numérotés file par file ; retire ceux de [premier, premier + nb)
+static Scenario sans_robots(const Scenario& scenario, size_t premier, size_t nb) {
+	Scenario essai;
+	size_t numero = 0;
+	essai.files.resize(scenario.files.size());
+	for (size_t file = 0; file < scenario.files.size(); ++file) {
+		for (int destination : scenario.files[file]) {
+			if (numero < premier || numero >= premier + nb) {
+				essai.files[file].push_back(destination);
+			}
+			++numero;
+		}
+	}
+	return essai;
+}
+
+static size_t compter_robots(const Scenario& scenario) {
+	size_t nb_robots = 0;
+	for (const std::vector<int>& robots : scenario.files) {
+		nb_robots += robots.size();
+	}
+	return nb_robots;
+}
+
+static Scenario reduire(Scenario scenario, const std::function<bool(const Scenario&)>& fautif) {
+	bool progres = true;
+	while (progres) {
+		progres = false;
+		for (size_t tranche = scenario.files.size() / 2; tranche >= 1; tranche /= 2) {
+			for (size_t premiere = 0; premiere + tranche <= scenario.files.size() && scenario.files.size() > 1;) {
+				Scenario essai = sans_files(scenario, premiere, tranche);
+				if (fautif(essai)) {
+					scenario = essai;
+					progres = true;
+				} else {
+					premiere += tranche;
+				}
+			}
+		}
+		for (size_t tranche = std::max<size_t>(compter_robots(scenario) / 2, 1); tranche >= 1; tranche /= 2) {
+			for (size_t premier = 0; premier + tranche <= compter_robots(scenario);) {
+				Scenario essai = sans_robots(scenario, premier, tranche);
+				if (fautif(essai)) {
+					scenario = essai;
+					progres = true;
+				} else {
+					premier += tranche;
+				}
+			}
+		}
+		for (size_t file = 0; file < scenario.files.size(); ++file) {
+			for (size_t r = 0; r < scenario.files[file].size(); ++r) {
+				for (int destination : {0, static_cast<int>(file)}) {
+					if (destination >= scenario.files[file][r]) {
+						continue;     // Toujours vers une sortie plus petite : la réduction se termine
+					}
+					Scenario essai = scenario;
+					essai.files[file][r] = destination;
+					if (fautif(essai)) {
+						scenario = essai;
+						progres = true;
+						break;
+					}
+				}
+			}
+		}
+	}
+	return scenario;
+}
+
+static int signaler(const std::string& ecart, const char* politique, const Scenario& scenario) {
+	std::printf("DIFFÉRENCE %s\nPolitique : %s\nScénario réduit (%zu files, %zu robots) :\n%s", ecart.c_str(),
+	            politique, scenario.files.size(), compter_robots(scenario),
+	            texte_scenario(scenario, "SHOW_CYCLES").c_str());
+	return 1;
+}
+
+static int usage(const char* programme) {
+	std::fprintf(stderr, "Usage : %s [--essais N] [--secondes S] [--graine G]\n", programme);
+	return 2;
+}
+
+int main(int argc, char* argv[]) {
+	long long nb_essais = 2000;
+	double secondes = 60;
+	std::uint64_t graine = 1;
+	for (int i = 1; i < argc; ++i) {
+		bool suivant = i + 1 < argc;
+		if (std::strcmp(argv[i], "--essais") == 0 && suivant) {
+			nb_essais = std::atoll(argv[++i]);
+		} else if (std::strcmp(argv[i], "--secondes") == 0 && suivant) {
+			secondes = std::atof(argv[++i]);
+		} else if (std::strcmp(argv[i], "--graine") == 0 && suivant) {
+			graine = std::strtoull(argv[++i], nullptr, 10);
+		} else {
+			return usage(argv[0]);
+		}
+	}
+	char modele[] = "/tmp/verification.XXXXXX";
+	if (mkdtemp(modele) == nullptr) {
+		std::fprintf(stderr, "Impossible de créer un dossier temporaire\n");
+		return 2;
+	}
+	std::string dossier = modele;
+	struct Nettoyage {
+		std::string dossier;
+		~Nettoyage() {
+			std::remove((dossier + "/trace").c_str());
+			std::remove((dossier + "/reprise").c_str());
+			rmdir(dossier.c_str());
+		}
+	} nettoyage{dossier};
+
+	auto debut = std::chrono::steady_clock::now();
+	auto ecoulees = [&] { return std::chrono::duration<double>(std::chrono::steady_clock::now() - debut).count(); };
+	std::mt19937_64 aleatoire(graine);
+	std::vector<Scenario> lot;
+	long long essai = 0;
+	for (; essai < nb_essais && ecoulees() < secondes; ++essai) {
+		Scenario scenario = tirer_scenario(aleatoire, static_cast<int>(essai));
+		for (int p = 0; p < 4; ++p) {
+			TypePolitique politique = static_cast<TypePolitique>(p);
+			std::string ecart = verifier(scenario, politique, dossier);
+			if (!ecart.empty()) {
+				Scenario reduit = reduire(scenario, [&](const Scenario& s) { return !verifier(s, politique, dossier).empty(); });
+				return signaler(verifier(reduit, politique, dossier), nom_politique(politique), reduit);
+			}
+		}
+		lot.push_back(scenario);
+		if (lot.size() == 32) {
+			size_t fautif = 0;
+			std::string ecart = verifier_lot(lot, dossier, &fautif);
+			if (!ecart.empty()) {
+				Scenario reduit = reduire(lot[fautif], [&](const Scenario& s) { return !verifier_lot({s}, dossier).empty(); });
+				return signaler(ecart, "NEQLI et FANEQLI (lot)", reduit);
+			}
+			lot.clear();
+		}
+	}
+	std::printf("%lld scénarios, %lld comparaisons en %.1f s : aucune différence\n", essai, nb_comparaisons,
+	            ecoulees());
+	return 0;
+}